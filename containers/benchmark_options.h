@@ -0,0 +1,25 @@
+// benchmark_options.h : command line and file helpers shared by the benchmark tools
+#pragma once
+#include <iostream>
+#include <string>
+
+namespace benchmark_options {
+    // true when arg is --name=..., value gets what follows the =
+    inline bool parse_option(const std::string &arg, const char *name, std::string &value) {
+        const std::string prefix = std::string("--") + name + "=";
+        if (arg.compare(0, prefix.size(), prefix) != 0)
+            return false;
+        value = arg.substr(prefix.size());
+        return true;
+    }
+
+    // opens path into an ifstream / ofstream, reporting the path on stderr when it cannot be opened
+    template <typename Stream> bool open_file(Stream &stream, const std::string &path) {
+        stream.open(path);
+        if (!stream) {
+            std::cerr << "could not open " << path << "\n";
+            return false;
+        }
+        return true;
+    }
+} // namespace benchmark_options
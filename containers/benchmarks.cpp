@@ -0,0 +1,434 @@
+// benchmarks.cpp : every container against its std equivalent, across operations, sizes and element types
+//
+// usage: containers_benchmarks [--max-size=N] [--max-bytes=N] [--type=int|pod64|string|move_only]
+//                              [--op=push_back|emplace_back|reserve|iterate|insert|erase]
+//                              [--csv=FILE] [--json=FILE] [--allocations] [--cache]
+// the csv file doubles as a baseline for containers_compare
+// --allocations adds allocs/op, bytes/op and peak bytes per op through counting_allocator / counting_resource
+//  (nanobench has no custom counters, so these are printed as their own table after each benchmark)
+// --cache adds L1d, LLC and dTLB misses and LLC bytes per op (Linux perf_event_open, needs perf_event_paranoid <= 2),
+//  the json file carries them too
+#include "benchmark_options.h"
+#include "counting_allocator.h"
+#include "nanobench.h"
+#include "plain_array.h"
+#include "real_vector.h"
+#include "stable_stack.h"
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+    struct pod64 {
+        uint64_t values[8];
+    };
+
+    // moves are not trivial (the source is reset) and copies don't exist
+    struct move_only {
+        size_t value = 0;
+
+        move_only() = default;
+        explicit move_only(size_t v) : value(v) {
+        }
+        move_only(const move_only &)            = delete;
+        move_only &operator=(const move_only &) = delete;
+        move_only(move_only &&other) noexcept : value(other.value) {
+            other.value = 0;
+        }
+        move_only &operator=(move_only &&other) noexcept {
+            value       = other.value;
+            other.value = 0;
+            return *this;
+        }
+    };
+
+    // how to make, emplace and read each element type
+    template <typename T> struct element;
+
+    template <> struct element<int> {
+        static constexpr const char *name = "int";
+        static int                   make(size_t i) {
+            return static_cast<int>(i);
+        }
+        template <typename Container> static void emplace(Container &c, size_t i) {
+            c.emplace_back(static_cast<int>(i));
+        }
+        static size_t key(const int &value) {
+            return static_cast<size_t>(value);
+        }
+    };
+
+    template <> struct element<pod64> {
+        static constexpr const char *name = "pod64";
+        static pod64                 make(size_t i) {
+            return pod64{{i, i + 1, i + 2, i + 3, i + 4, i + 5, i + 6, i + 7}};
+        }
+        template <typename Container> static void emplace(Container &c, size_t i) {
+            c.emplace_back(make(i));
+        }
+        static size_t key(const pod64 &value) {
+            return static_cast<size_t>(value.values[0]);
+        }
+    };
+
+    // long enough to defeat the small string optimization
+    inline constexpr const char long_text[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+
+    template <> struct element<std::string> {
+        static constexpr const char *name = "std::string";
+        static std::string           make(size_t i) {
+            return std::string(long_text + (i % 4), 32);
+        }
+        template <typename Container> static void emplace(Container &c, size_t i) {
+            c.emplace_back(long_text + (i % 4), size_t{32});
+        }
+        static size_t key(const std::string &value) {
+            return value.size() + static_cast<size_t>(value[0]);
+        }
+    };
+
+    template <> struct element<move_only> {
+        static constexpr const char *name = "move_only";
+        static move_only             make(size_t i) {
+            return move_only{i};
+        }
+        template <typename Container> static void emplace(Container &c, size_t i) {
+            c.emplace_back(i);
+        }
+        static size_t key(const move_only &value) {
+            return value.value;
+        }
+    };
+
+    // std::array + size, a boost::static_vector style baseline
+    template <typename T, size_t N> struct array_with_size {
+        using value_type = T;
+
+        std::array<T, N> _values{};
+        size_t           _size = 0;
+
+        T *begin() {
+            return _values.data();
+        }
+        T *end() {
+            return _values.data() + _size;
+        }
+        size_t size() const {
+            return _size;
+        }
+        void clear() {
+            _size = 0;
+        }
+        template <typename... Args> T &emplace_back(Args &&...args) {
+            _values[_size] = T(std::forward<Args>(args)...);
+            return _values[_size++];
+        }
+        void push_back(T &&value) {
+            _values[_size++] = std::move(value);
+        }
+        void pop_back() {
+            _size--;
+        }
+        T *insert(T *pos, T &&value) {
+            std::move_backward(pos, end(), end() + 1);
+            *pos = std::move(value);
+            _size++;
+            return pos;
+        }
+        T *erase(T *pos) {
+            std::move(pos + 1, end(), pos);
+            _size--;
+            return pos;
+        }
+    };
+
+    // fixed capacity containers are cleared and reused, dynamic ones are rebuilt every iteration
+    template <typename Container> struct is_fixed_capacity : std::false_type {};
+    template <typename T, size_t N> struct is_fixed_capacity<containers::plain_array<T, N>> : std::true_type {};
+    template <typename T, size_t N>
+    struct is_fixed_capacity<containers::plain_array_safe<T, N>> : std::true_type {};
+    template <typename T, size_t N> struct is_fixed_capacity<array_with_size<T, N>> : std::true_type {};
+
+    struct options {
+        size_t      max_size  = 100000;
+        size_t      max_bytes = size_t{1} << 30;
+        std::string type;
+        std::string op;
+        std::string csv;
+        std::string json;
+        bool        allocations = false;
+        bool        cache       = false;
+    };
+
+    template <typename Container> void fill(Container &c, size_t n) {
+        using T = typename Container::value_type;
+        for (size_t i = 0; i < n; i++)
+            c.push_back(element<T>::make(i));
+    }
+
+    template <typename Container> std::unique_ptr<Container> make_filled(size_t n) {
+        auto c = std::make_unique<Container>();
+        fill(*c, n);
+        return c;
+    }
+
+    // starts the counters over right before the measured op, after any setup
+    //  snapshot gets the counters as they stood at the end of the op, before the caller tears its container down
+    template <typename Fn>
+    void measure(ankerl::nanobench::Bench &bench, const char *name, containers::allocation_stats *snapshot,
+                 Fn &&fn) {
+        containers::allocation_stats *stats = &containers::default_allocation_stats();
+        stats->reset();
+        if (auto *resource = dynamic_cast<containers::counting_resource *>(std::pmr::get_default_resource())) {
+            stats = &resource->stats();
+            stats->reset();
+        }
+        if (!snapshot) {
+            bench.run(name, std::forward<Fn>(fn));
+            return;
+        }
+        bench.run(name, [&]() {
+            fn();
+            *snapshot = *stats;
+        });
+    }
+
+    // runs op on one container, container names come from the caller
+    template <typename Container>
+    void run_op(ankerl::nanobench::Bench &bench, const std::string &op, const char *name, size_t n,
+                containers::allocation_stats *snapshot = nullptr) {
+        using T = typename Container::value_type;
+        if (op == "push_back" || op == "emplace_back") {
+            const bool emplace = op == "emplace_back";
+            bench.batch(n);
+            if constexpr (is_fixed_capacity<Container>::value) {
+                auto c = std::make_unique<Container>();
+                measure(bench, name, snapshot, [&]() {
+                    c->clear();
+                    for (size_t i = 0; i < n; i++) {
+                        if (emplace)
+                            element<T>::emplace(*c, i);
+                        else
+                            c->push_back(element<T>::make(i));
+                    }
+                    ankerl::nanobench::doNotOptimizeAway(c->size());
+                });
+            } else {
+                measure(bench, name, snapshot, [&]() {
+                    Container c;
+                    for (size_t i = 0; i < n; i++) {
+                        if (emplace)
+                            element<T>::emplace(c, i);
+                        else
+                            c.push_back(element<T>::make(i));
+                    }
+                    ankerl::nanobench::doNotOptimizeAway(c.size());
+                });
+            }
+        } else if (op == "reserve") {
+            if constexpr (!is_fixed_capacity<Container>::value && requires(Container & c) { c.reserve(n); }) {
+                bench.batch(n);
+                measure(bench, name, snapshot, [&]() {
+                    Container c;
+                    c.reserve(n);
+                    for (size_t i = 0; i < n; i++)
+                        c.push_back(element<T>::make(i));
+                    ankerl::nanobench::doNotOptimizeAway(c.size());
+                });
+            }
+        } else if (op == "iterate") {
+            auto c = make_filled<Container>(n);
+            bench.batch(n);
+            measure(bench, name, snapshot, [&]() {
+                size_t sum = 0;
+                for (auto &value : *c)
+                    sum += element<T>::key(value);
+                ankerl::nanobench::doNotOptimizeAway(sum);
+            });
+        } else if (op == "insert") {
+            // one insert in the middle, pop_back restores the size
+            if constexpr (requires(Container & c) { c.insert(c.begin(), T{}); }) {
+                auto   c = make_filled<Container>(n - 1);
+                size_t i = 0;
+                bench.batch(1);
+                measure(bench, name, snapshot, [&]() {
+                    c->insert(c->begin() + (c->size() / 2), element<T>::make(i++));
+                    c->pop_back();
+                });
+            }
+        } else if (op == "erase") {
+            // one erase in the middle, push_back restores the size
+            if constexpr (requires(Container & c) { c.erase(c.begin()); }) {
+                auto   c = make_filled<Container>(n);
+                size_t i = 0;
+                bench.batch(1);
+                measure(bench, name, snapshot, [&]() {
+                    c->erase(c->begin() + (c->size() / 2));
+                    c->push_back(element<T>::make(i++));
+                });
+            }
+        }
+    }
+
+    inline constexpr size_t fixed_sizes[] = {8, 64, 512, 4096};
+
+    // calls fn.template operator()<N>() when n is one of the fixed capacities
+    template <typename Fn, size_t... Idxs>
+    bool with_fixed_capacity(size_t n, Fn &&fn, std::index_sequence<Idxs...>) {
+        return ((n == fixed_sizes[Idxs] ? (fn.template operator()<fixed_sizes[Idxs]>(), true) : false) || ...);
+    }
+
+    // runs op exactly once for each allocating container and prints the counters per op
+    template <typename T> void report_allocations(const std::string &op, size_t n) {
+        ankerl::nanobench::Bench bench;
+        bench.output(nullptr);
+        bench.warmup(0);
+        bench.epochs(1);
+        bench.epochIterations(1);
+
+        std::cout << "\n| allocs/op | deallocs/op | reallocs/op |   bytes/op |   peak bytes | " << op << " "
+                  << element<T>::name << " n=" << n << " allocations\n"
+                  << "|----------:|------------:|------------:|-----------:|-------------:|:-----------------\n";
+
+        // reallocations counts allocations made while another block is live, for std::deque those are
+        //  just new chunks, so its column stays empty
+        containers::allocation_stats stats;
+        const auto row = [&](const char *name, bool reallocations = true) {
+            if (bench.results().empty())
+                return;
+            const double batch = bench.results().back().config().mBatch;
+            std::printf("| %9.3f | %11.3f | ", stats.allocations / batch, stats.deallocations / batch);
+            if (reallocations)
+                std::printf("%11.3f | ", stats.reallocations / batch);
+            else
+                std::printf("%11s | ", "");
+            std::printf("%10.1f | %12zu | `%s`\n", stats.bytes_allocated / batch, stats.peak_bytes, name);
+        };
+
+        run_op<std::vector<T, containers::counting_allocator<T>>>(bench, op, "std::vector", n, &stats);
+        row("std::vector");
+        const size_t before_real = bench.results().size();
+        run_op<real::vector<T, containers::counting_allocator<T>>>(bench, op, "real::vector", n, &stats);
+        if (bench.results().size() != before_real)
+            row("real::vector");
+        const size_t before_deque = bench.results().size();
+        run_op<std::deque<T, containers::counting_allocator<T>>>(bench, op, "std::deque", n, &stats);
+        if (bench.results().size() != before_deque)
+            row("std::deque", false);
+
+        // pmr containers pick the counting resource up as the default resource
+        containers::counting_resource resource(std::pmr::new_delete_resource());
+        std::pmr::memory_resource    *previous = std::pmr::set_default_resource(&resource);
+        const size_t                  before_pmr = bench.results().size();
+        run_op<pmr::real::vector<T>>(bench, op, "pmr::real::vector", n, &stats);
+        if (bench.results().size() != before_pmr)
+            row("pmr::real::vector");
+        std::pmr::set_default_resource(previous);
+    }
+
+    template <typename T> void run_type(const options &opts, std::vector<ankerl::nanobench::Result> &results) {
+        const char *ops[] = {"push_back", "emplace_back", "reserve", "iterate", "insert", "erase"};
+        for (const char *op : ops) {
+            if (!opts.op.empty() && opts.op != op)
+                continue;
+            for (size_t n = 8; n <= opts.max_size; n = (n >= 16777216 && n < 100000000) ? 100000000 : n * 8) {
+                if (n * sizeof(T) > opts.max_bytes)
+                    break;
+
+                ankerl::nanobench::Bench bench;
+                bench.title(std::string(op) + " " + element<T>::name + " n=" + std::to_string(n));
+                bench.unit(op);
+                bench.warmup(1);
+                bench.minEpochIterations(1);
+                bench.epochs(n >= 1048576 ? 3 : 11);
+                bench.performanceCounters(true);
+                bench.cacheCounters(opts.cache);
+                bench.relative(true);
+
+                run_op<std::vector<T>>(bench, op, "std::vector", n);
+                run_op<real::vector<T>>(bench, op, "real::vector", n);
+                run_op<std::deque<T>>(bench, op, "std::deque", n);
+                run_op<stable_stack<T>>(bench, op, "stable_stack", n);
+                with_fixed_capacity(
+                    n,
+                    [&]<size_t N>() {
+                        run_op<array_with_size<T, N>>(bench, op, "std::array + size", n);
+                        run_op<containers::plain_array<T, N>>(bench, op, "plain_array", n);
+                        run_op<containers::plain_array_safe<T, N>>(bench, op, "plain_array_safe", n);
+                    },
+                    std::make_index_sequence<std::size(fixed_sizes)>{});
+                results.insert(results.end(), bench.results().begin(), bench.results().end());
+                if (opts.allocations)
+                    report_allocations<T>(op, n);
+
+                if (n == 100000000)
+                    break;
+            }
+        }
+    }
+
+    bool write_results(const std::string &path, const char *mustache_template,
+                       const std::vector<ankerl::nanobench::Result> &results) {
+        std::ofstream out;
+        if (!benchmark_options::open_file(out, path))
+            return false;
+        ankerl::nanobench::render(mustache_template, results, out);
+        return true;
+    }
+} // namespace bench
+
+int main(int argc, char **argv) {
+    bench::options opts;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        std::string       value;
+        if (benchmark_options::parse_option(arg, "max-size", value)) {
+            opts.max_size = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (benchmark_options::parse_option(arg, "max-bytes", value)) {
+            opts.max_bytes = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (benchmark_options::parse_option(arg, "type", value)) {
+            opts.type = value;
+        } else if (benchmark_options::parse_option(arg, "op", value)) {
+            opts.op = value;
+        } else if (benchmark_options::parse_option(arg, "csv", value)) {
+            opts.csv = value;
+        } else if (benchmark_options::parse_option(arg, "json", value)) {
+            opts.json = value;
+        } else if (arg == "--allocations") {
+            opts.allocations = true;
+        } else if (arg == "--cache") {
+            opts.cache = true;
+        } else {
+            std::cerr << "usage: " << argv[0]
+                      << " [--max-size=N] [--max-bytes=N] [--type=int|pod64|string|move_only]"
+                         " [--op=push_back|emplace_back|reserve|iterate|insert|erase] [--csv=FILE] [--json=FILE] [--allocations]"
+                         " [--cache]\n";
+            return 1;
+        }
+    }
+
+    std::vector<ankerl::nanobench::Result> results;
+    if (opts.type.empty() || opts.type == "int")
+        bench::run_type<int>(opts, results);
+    if (opts.type.empty() || opts.type == "pod64")
+        bench::run_type<bench::pod64>(opts, results);
+    if (opts.type.empty() || opts.type == "string")
+        bench::run_type<std::string>(opts, results);
+    if (opts.type.empty() || opts.type == "move_only")
+        bench::run_type<bench::move_only>(opts, results);
+
+    if (!opts.csv.empty() && !bench::write_results(opts.csv, ankerl::nanobench::templates::csv(), results))
+        return 1;
+    if (!opts.json.empty() && !bench::write_results(opts.json, ankerl::nanobench::templates::json(), results))
+        return 1;
+    return 0;
+}
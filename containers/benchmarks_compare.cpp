@@ -0,0 +1,158 @@
+// benchmarks_compare.cpp : compares two containers_benchmarks --csv runs and fails on significant slowdowns
+//
+// usage: containers_compare BASELINE.csv CURRENT.csv [--threshold=PERCENT]
+//
+// a benchmark regresses when a per op metric grows by more than the threshold (default 5%)
+//  ns/op also has to grow by more than the combined median absolute percent error of both runs
+//  instructions/op and branch-misses/op are close to deterministic and only use the threshold,
+//  they are skipped when either run had no performance counters (nanobench writes 0)
+// exits with 1 when anything regressed
+#include "benchmark_options.h"
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace compare {
+    struct row {
+        double batch         = 1.0;
+        double elapsed       = 0.0; // seconds per iteration
+        double error         = 0.0; // fraction, not percent
+        double instructions  = 0.0;
+        double branch_misses = 0.0;
+    };
+
+    using key = std::pair<std::string, std::string>; // title, name
+
+    // splits one line of nanobench's csv template ("quoted";unquoted;...)
+    std::vector<std::string> split(const std::string &line) {
+        std::vector<std::string> fields(1);
+        bool                     quoted = false;
+        for (char c : line) {
+            if (c == '"')
+                quoted = !quoted;
+            else if (c == ';' && !quoted)
+                fields.emplace_back();
+            else if (c != '\r')
+                fields.back() += c;
+        }
+        return fields;
+    }
+
+    bool load(const std::string &path, std::map<key, row> &rows, std::vector<key> &order) {
+        std::ifstream in;
+        if (!benchmark_options::open_file(in, path))
+            return false;
+        std::string line;
+        std::getline(in, line); // header
+        // "title";"name";"unit";"batch";"elapsed";"error %";"instructions";"branches";"branch misses";"total"
+        while (std::getline(in, line)) {
+            if (line.empty())
+                continue;
+            const std::vector<std::string> fields = split(line);
+            if (fields.size() < 9) {
+                std::cerr << path << ": malformed line: " << line << "\n";
+                return false;
+            }
+            row r;
+            r.batch         = std::strtod(fields[3].c_str(), nullptr);
+            r.elapsed       = std::strtod(fields[4].c_str(), nullptr);
+            r.error         = std::strtod(fields[5].c_str(), nullptr);
+            r.instructions  = std::strtod(fields[6].c_str(), nullptr);
+            r.branch_misses = std::strtod(fields[8].c_str(), nullptr);
+            if (r.batch <= 0.0)
+                r.batch = 1.0;
+            key k{fields[0], fields[1]};
+            if (rows.emplace(k, r).second)
+                order.push_back(std::move(k));
+        }
+        return true;
+    }
+
+    struct metric {
+        const char *name;
+        double      baseline;
+        double      current;
+        double      noise; // fraction that must be exceeded on top of the threshold
+    };
+
+    std::string percent(double fraction) {
+        std::ostringstream out;
+        out << std::showpos << std::fixed << std::setprecision(1) << fraction * 100.0 << "%";
+        return out.str();
+    }
+} // namespace compare
+
+int main(int argc, char **argv) {
+    std::vector<std::string> files;
+    double                   threshold = 0.05;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        std::string       value;
+        if (benchmark_options::parse_option(arg, "threshold", value)) {
+            char *end = nullptr;
+            threshold = std::strtod(value.c_str(), &end) / 100.0;
+            if (value.empty() || *end || !std::isfinite(threshold) || threshold < 0.0) {
+                std::cerr << "--threshold needs a percentage >= 0, got '" << value << "'\n";
+                return 2;
+            }
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.size() != 2) {
+        std::cerr << "usage: " << argv[0] << " BASELINE.csv CURRENT.csv [--threshold=PERCENT]\n";
+        return 2;
+    }
+
+    std::map<compare::key, compare::row> baseline, current;
+    std::vector<compare::key>            baseline_order, current_order;
+    if (!compare::load(files[0], baseline, baseline_order) || !compare::load(files[1], current, current_order))
+        return 2;
+
+    size_t regressions = 0;
+    size_t compared    = 0;
+    for (const compare::key &k : current_order) {
+        const auto it = baseline.find(k);
+        if (it == baseline.end()) {
+            std::cout << "new:       " << k.first << " | " << k.second << "\n";
+            continue;
+        }
+        const compare::row &b = it->second;
+        const compare::row &c = current.find(k)->second;
+        compared++;
+
+        const compare::metric metrics[] = {
+            {"ns/op", b.elapsed * 1e9 / b.batch, c.elapsed * 1e9 / c.batch, b.error + c.error},
+            {"instructions/op", b.instructions / b.batch, c.instructions / c.batch, 0.0},
+            {"branch-misses/op", b.branch_misses / b.batch, c.branch_misses / c.batch, 0.0},
+        };
+        for (const compare::metric &m : metrics) {
+            if (m.baseline <= 0.0 || m.current <= 0.0)
+                continue;
+            const double change = m.current / m.baseline - 1.0;
+            if (change > threshold && change > m.noise) {
+                regressions++;
+                std::cout << "REGRESSION " << k.first << " | " << k.second << " | " << m.name << " " << m.baseline
+                          << " -> " << m.current << " (" << compare::percent(change) << ", noise "
+                          << compare::percent(m.noise) << ")\n";
+            } else if (-change > threshold && -change > m.noise) {
+                std::cout << "improved:  " << k.first << " | " << k.second << " | " << m.name << " " << m.baseline
+                          << " -> " << m.current << " (" << compare::percent(change) << ")\n";
+            }
+        }
+    }
+    for (const compare::key &k : baseline_order) {
+        if (current.find(k) == current.end())
+            std::cout << "missing:   " << k.first << " | " << k.second << "\n";
+    }
+
+    std::cout << compared << " benchmarks compared, " << regressions << " regressions\n";
+    return regressions ? 1 : 0;
+}
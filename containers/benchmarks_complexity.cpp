@@ -0,0 +1,264 @@
+// benchmarks_complexity.cpp : fits each container operation to a complexity with nanobench's BigO
+//
+// usage: containers_complexity [--min-size=N] [--max-size=N] [--tolerance=F] [--retries=N] [--case=NAME]
+//
+// every case runs over a geometric sweep of container sizes, each iteration leaves the size unchanged
+// a sweep mismatches when the best fit is worse than its documented bound, unless the documented bound fits
+//  within tolerance (normalized root mean square) of the best one
+// timer noise alone makes an O(1) operation fit O(log n) now and then (a full run at tolerance 0.1 and 7 epochs
+//  tripped on one case about 1 time in 3), so a mismatching case is swept again up to --retries times and only
+//  fails when every sweep mismatches, exits with 1 when any case failed
+#include "benchmark_options.h"
+#include "nanobench.h"
+#include "plain_array.h"
+#include "real_vector.h"
+#include "stable_stack.h"
+#include <cstdlib>
+#include <forward_list>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace complexity {
+    // largest size plain_array cases can reach
+    inline constexpr size_t plain_array_capacity = size_t{1} << 16;
+    // elements handed to the insert_range cases
+    inline constexpr size_t range_count = 16;
+
+    // complexities in the order nanobench fits them, cheapest first
+    inline constexpr const char *bounds[] = {"O(1)", "O(log n)", "O(n)", "O(n log n)", "O(n^2)", "O(n^3)"};
+
+    int bound_rank(const std::string &name) {
+        for (size_t i = 0; i < std::size(bounds); i++) {
+            if (name == bounds[i])
+                return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    struct options {
+        size_t      min_size  = 1024;
+        size_t      max_size  = size_t{1} << 16;
+        double      tolerance = 0.15;
+        size_t      retries   = 2;
+        std::string only;
+    };
+
+    struct test_case {
+        const char *name;
+        const char *bound;
+        void (*run)(ankerl::nanobench::Bench &bench, size_t n);
+        size_t      size_limit = static_cast<size_t>(-1);
+    };
+
+    template <typename Container> std::unique_ptr<Container> make_filled(size_t n) {
+        auto c = std::make_unique<Container>();
+        for (size_t i = 0; i < n; i++)
+            c->push_back(static_cast<int>(i));
+        return c;
+    }
+
+    using int_vector = real::vector<int>;
+    using int_array  = containers::plain_array<int, plain_array_capacity>;
+
+    void vector_insert_front(ankerl::nanobench::Bench &bench, size_t n) {
+        auto c = make_filled<int_vector>(n);
+        bench.run("real::vector insert front", [&]() {
+            c->insert(c->begin(), 1);
+            c->pop_back();
+        });
+    }
+
+    void vector_insert_middle(ankerl::nanobench::Bench &bench, size_t n) {
+        auto c = make_filled<int_vector>(n);
+        bench.run("real::vector insert middle", [&]() {
+            c->insert(c->begin() + (c->size() / 2), 1);
+            c->pop_back();
+        });
+    }
+
+    void vector_insert_back(ankerl::nanobench::Bench &bench, size_t n) {
+        auto c = make_filled<int_vector>(n);
+        bench.run("real::vector insert back", [&]() {
+            c->insert(c->end(), 1);
+            c->pop_back();
+        });
+    }
+
+    void vector_push_back(ankerl::nanobench::Bench &bench, size_t n) {
+        auto c = make_filled<int_vector>(n);
+        bench.run("real::vector push_back", [&]() {
+            c->push_back(1);
+            c->pop_back();
+        });
+    }
+
+    void vector_index(ankerl::nanobench::Bench &bench, size_t n) {
+        auto                   c = make_filled<int_vector>(n);
+        ankerl::nanobench::Rng rng(n);
+        bench.run("real::vector operator[]", [&]() {
+            ankerl::nanobench::doNotOptimizeAway((*c)[rng.bounded(static_cast<uint32_t>(n))]);
+        });
+    }
+
+    // range_count values from a forward_list or a std::vector, at the front or at the back
+    template <typename Range> void vector_insert_range(ankerl::nanobench::Bench &bench, size_t n, bool front,
+                                                      const char *name) {
+        auto  c = make_filled<int_vector>(n);
+        Range values(range_count, 1);
+        bench.run(name, [&]() {
+            c->insert(front ? c->begin() : c->end(), values.begin(), values.end());
+            c->erase(c->end() - range_count, c->end());
+        });
+    }
+
+    void vector_insert_range_forward_front(ankerl::nanobench::Bench &bench, size_t n) {
+        vector_insert_range<std::forward_list<int>>(bench, n, true, "real::vector insert_range forward front");
+    }
+
+    void vector_insert_range_forward_back(ankerl::nanobench::Bench &bench, size_t n) {
+        vector_insert_range<std::forward_list<int>>(bench, n, false, "real::vector insert_range forward back");
+    }
+
+    void vector_insert_range_random_front(ankerl::nanobench::Bench &bench, size_t n) {
+        vector_insert_range<std::vector<int>>(bench, n, true, "real::vector insert_range random access front");
+    }
+
+    void vector_insert_range_random_back(ankerl::nanobench::Bench &bench, size_t n) {
+        vector_insert_range<std::vector<int>>(bench, n, false, "real::vector insert_range random access back");
+    }
+
+    void array_erase_front(ankerl::nanobench::Bench &bench, size_t n) {
+        auto c = make_filled<int_array>(n);
+        bench.run("plain_array erase front", [&]() {
+            c->erase(c->begin());
+            c->push_back(1);
+        });
+    }
+
+    void array_erase_back(ankerl::nanobench::Bench &bench, size_t n) {
+        auto c = make_filled<int_array>(n);
+        bench.run("plain_array erase back", [&]() {
+            c->erase(c->end() - 1);
+            c->push_back(1);
+        });
+    }
+
+    void array_insert_front(ankerl::nanobench::Bench &bench, size_t n) {
+        auto c = make_filled<int_array>(n - 1);
+        bench.run("plain_array insert front", [&]() {
+            c->insert(c->begin(), 1);
+            c->pop_back();
+        });
+    }
+
+    void stack_index(ankerl::nanobench::Bench &bench, size_t n) {
+        auto                   c = make_filled<stable_stack<int>>(n);
+        ankerl::nanobench::Rng rng(n);
+        bench.run("stable_stack operator[]", [&]() {
+            ankerl::nanobench::doNotOptimizeAway((*c)[rng.bounded(static_cast<uint32_t>(n))]);
+        });
+    }
+
+    void stack_push_back(ankerl::nanobench::Bench &bench, size_t n) {
+        auto c = make_filled<stable_stack<int>>(n);
+        bench.run("stable_stack push_back", [&]() {
+            c->push_back(1);
+            c->pop_back();
+        });
+    }
+
+    inline constexpr test_case cases[] = {
+        {"vector_insert_front", "O(n)", vector_insert_front},
+        {"vector_insert_middle", "O(n)", vector_insert_middle},
+        {"vector_insert_back", "O(1)", vector_insert_back},
+        {"vector_push_back", "O(1)", vector_push_back},
+        {"vector_index", "O(1)", vector_index},
+        {"vector_insert_range_forward_front", "O(n)", vector_insert_range_forward_front},
+        {"vector_insert_range_forward_back", "O(1)", vector_insert_range_forward_back},
+        {"vector_insert_range_random_front", "O(n)", vector_insert_range_random_front},
+        {"vector_insert_range_random_back", "O(1)", vector_insert_range_random_back},
+        {"array_erase_front", "O(n)", array_erase_front, plain_array_capacity},
+        {"array_erase_back", "O(1)", array_erase_back, plain_array_capacity},
+        {"array_insert_front", "O(n)", array_insert_front, plain_array_capacity},
+        {"stack_index", "O(1)", stack_index},
+        {"stack_push_back", "O(1)", stack_push_back},
+    };
+
+    // runs the sweep and checks the fit, true when the case matches its bound
+    bool run_case(const test_case &tc, const options &opts) {
+        ankerl::nanobench::Bench bench;
+        bench.title(tc.name);
+        bench.warmup(16);
+        bench.epochs(11);
+        bench.output(nullptr);
+
+        const size_t max_size = opts.max_size < tc.size_limit ? opts.max_size : tc.size_limit;
+        for (size_t n = opts.min_size; n <= max_size; n *= 2) {
+            bench.complexityN(n);
+            tc.run(bench, n);
+        }
+
+        const std::vector<ankerl::nanobench::BigO> fits = bench.complexityBigO();
+        const ankerl::nanobench::BigO             &best = fits.front();
+        const int                                  rank = bound_rank(tc.bound);
+
+        bool matches = bound_rank(best.name()) <= rank;
+        for (const ankerl::nanobench::BigO &fit : fits) {
+            if (fit.name() == tc.bound &&
+                fit.normalizedRootMeanSquare() <= best.normalizedRootMeanSquare() + opts.tolerance)
+                matches = true;
+        }
+
+        std::cout << "\n" << tc.name << ": documented " << tc.bound << ", fitted " << best.name() << " -> "
+                  << (matches ? "ok" : "MISMATCH") << "\n"
+                  << fits << "\n";
+        return matches;
+    }
+} // namespace complexity
+
+int main(int argc, char **argv) {
+    complexity::options opts;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        std::string       value;
+        if (benchmark_options::parse_option(arg, "min-size", value)) {
+            opts.min_size = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (benchmark_options::parse_option(arg, "max-size", value)) {
+            opts.max_size = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (benchmark_options::parse_option(arg, "tolerance", value)) {
+            opts.tolerance = std::strtod(value.c_str(), nullptr);
+        } else if (benchmark_options::parse_option(arg, "retries", value)) {
+            opts.retries = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (benchmark_options::parse_option(arg, "case", value)) {
+            opts.only = value;
+        } else {
+            std::cerr << "usage: " << argv[0]
+                      << " [--min-size=N] [--max-size=N] [--tolerance=F] [--retries=N] [--case=NAME]\n"
+                         "a case fails only when all 1 + retries (default 2) sweeps mismatch, timer noise can fit an\n"
+                         "O(1) operation as O(log n) in a single sweep, tolerance (default 0.15) is the normalized rms\n"
+                         "error the documented bound may trail the best fit by\n";
+            return 2;
+        }
+    }
+    if (opts.min_size < 2 || opts.max_size < opts.min_size * 4) {
+        std::cerr << "the sweep needs --min-size >= 2 and --max-size >= 4 * --min-size\n";
+        return 2;
+    }
+
+    size_t mismatches = 0;
+    for (const complexity::test_case &tc : complexity::cases) {
+        if (!opts.only.empty() && opts.only != tc.name)
+            continue;
+        bool matches = complexity::run_case(tc, opts);
+        for (size_t retry = 0; !matches && retry < opts.retries; retry++) {
+            std::cout << tc.name << ": sweeping again (" << retry + 1 << " of " << opts.retries << ")\n";
+            matches = complexity::run_case(tc, opts);
+        }
+        if (!matches)
+            mismatches++;
+    }
+    std::cout << "\n" << mismatches << " complexity mismatches\n";
+    return mismatches ? 1 : 0;
+}
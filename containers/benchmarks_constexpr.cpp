@@ -0,0 +1,175 @@
+// benchmarks_constexpr.cpp : compile time and compiler memory of constant evaluated plain_array workloads
+//
+// usage: containers_constexpr [--compiler=PATH] [--min-size=N] [--max-size=N] [--ops=N] [--workload=NAME]
+//                             [--include=DIR] [--csv=FILE]
+//
+// compiles constexpr_workload.cpp with -fsyntax-only for every workload and capacity (doubling from --min-size=32
+//  up to --max-size=8192, 65536 for the full sweep), timing the compiler and reading its peak RSS back from wait4
+// the compiler defaults to the one this target was built with, gcc and clang get their constexpr limits lifted
+// --include points at another copy of the headers, to compare before / after a change
+#include "benchmark_options.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define CONTAINERS_CONSTEXPR_BENCH 1
+#endif
+
+#ifndef CONTAINERS_CXX_COMPILER
+#define CONTAINERS_CXX_COMPILER "c++"
+#endif
+#ifndef CONTAINERS_SOURCE_DIR
+#define CONTAINERS_SOURCE_DIR "."
+#endif
+
+namespace constexpr_bench {
+    // in CONSTEXPR_WORKLOAD order
+    inline constexpr const char *workloads[] = {"push_back", "insert", "insert_rotate", "insert_range", "emplace"};
+
+    struct options {
+        std::string compiler = CONTAINERS_CXX_COMPILER;
+        std::string include  = CONTAINERS_SOURCE_DIR;
+        size_t      min_size = 32;
+        size_t      max_size = 8192;
+        size_t      ops      = 64;
+        std::string workload;
+        std::string csv;
+    };
+
+    struct measurement {
+        bool   ok      = false;
+        double seconds = 0.0;
+        long   max_rss = 0; // KiB
+    };
+
+#if CONTAINERS_CONSTEXPR_BENCH
+    // runs args[0] with its output discarded, true when it exited with 0
+    measurement run(const std::vector<std::string> &args) {
+        std::vector<char *> argv;
+        for (const std::string &arg : args)
+            argv.push_back(const_cast<char *>(arg.c_str()));
+        argv.push_back(nullptr);
+
+        measurement result;
+        std::fflush(nullptr); // the child would write out our buffered output again
+        const auto  start = std::chrono::steady_clock::now();
+        const pid_t pid   = fork();
+        if (pid < 0)
+            return result;
+        if (pid == 0) {
+            std::freopen("/dev/null", "w", stdout);
+            execvp(argv[0], argv.data());
+            _exit(127);
+        }
+        int           status = 0;
+        struct rusage usage  = {};
+        if (wait4(pid, &status, 0, &usage) != pid)
+            return result;
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.max_rss = usage.ru_maxrss;
+        result.ok      = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        return result;
+    }
+
+    bool is_clang(const std::string &compiler) {
+        const std::string command = compiler + " --version 2>/dev/null";
+        FILE             *pipe    = popen(command.c_str(), "r");
+        if (!pipe)
+            return false;
+        std::string version;
+        char        buffer[256];
+        while (std::fgets(buffer, sizeof(buffer), pipe))
+            version += buffer;
+        pclose(pipe);
+        return version.find("clang") != std::string::npos;
+    }
+#endif
+} // namespace constexpr_bench
+
+int main(int argc, char **argv) {
+    constexpr_bench::options opts;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        std::string       value;
+        if (benchmark_options::parse_option(arg, "compiler", value)) {
+            opts.compiler = value;
+        } else if (benchmark_options::parse_option(arg, "include", value)) {
+            opts.include = value;
+        } else if (benchmark_options::parse_option(arg, "min-size", value)) {
+            opts.min_size = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (benchmark_options::parse_option(arg, "max-size", value)) {
+            opts.max_size = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (benchmark_options::parse_option(arg, "ops", value)) {
+            opts.ops = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (benchmark_options::parse_option(arg, "workload", value)) {
+            opts.workload = value;
+        } else if (benchmark_options::parse_option(arg, "csv", value)) {
+            opts.csv = value;
+        } else {
+            std::cerr << "usage: " << argv[0]
+                      << " [--compiler=PATH] [--min-size=N] [--max-size=N] [--ops=N] [--workload=NAME]"
+                         " [--include=DIR] [--csv=FILE]\n";
+            return 2;
+        }
+    }
+    // the sweep doubles n, from 0 it would never end
+    if (opts.min_size == 0 || opts.max_size < opts.min_size) {
+        std::cerr << "the sweep needs --min-size >= 1 and --max-size >= --min-size\n";
+        return 2;
+    }
+
+#if CONTAINERS_CONSTEXPR_BENCH
+    std::ofstream csv;
+    if (!opts.csv.empty()) {
+        if (!benchmark_options::open_file(csv, opts.csv))
+            return 2;
+        csv << "\"workload\";\"n\";\"ops\";\"seconds\";\"max rss KiB\"\n";
+    }
+
+    const std::string limits = constexpr_bench::is_clang(opts.compiler) ? "-fconstexpr-steps=2147483647"
+                                                                        : "-fconstexpr-ops-limit=68719476736";
+    const std::string source = std::string(CONTAINERS_SOURCE_DIR) + "/constexpr_workload.cpp";
+
+    std::printf("%s, %zu inserts and erases per workload\n\n", opts.compiler.c_str(), opts.ops);
+    std::printf("|        n |    seconds |  max rss MiB | workload\n"
+                "|---------:|-----------:|-------------:|:--------\n");
+    int failures = 0;
+    for (size_t w = 0; w < std::size(constexpr_bench::workloads); w++) {
+        const char *name = constexpr_bench::workloads[w];
+        if (!opts.workload.empty() && opts.workload != name)
+            continue;
+        for (size_t n = opts.min_size; n <= opts.max_size; n *= 2) {
+            const std::vector<std::string> args = {opts.compiler,
+                                                   "-std=c++20",
+                                                   "-fsyntax-only",
+                                                   limits,
+                                                   "-I" + opts.include,
+                                                   "-DCONSTEXPR_N=" + std::to_string(n),
+                                                   "-DCONSTEXPR_OPS=" + std::to_string(opts.ops),
+                                                   "-DCONSTEXPR_WORKLOAD=" + std::to_string(w),
+                                                   source};
+            const constexpr_bench::measurement m = constexpr_bench::run(args);
+            if (!m.ok) {
+                std::printf("| %8zu |     failed |              | `%s`\n", n, name);
+                failures++;
+                break;
+            }
+            std::printf("| %8zu | %10.3f | %12.1f | `%s`\n", n, m.seconds, m.max_rss / 1024.0, name);
+            if (csv.is_open())
+                csv << '"' << name << "\";" << n << ';' << opts.ops << ';' << m.seconds << ';' << m.max_rss << "\n";
+        }
+    }
+    return failures ? 1 : 0;
+#else
+    std::cerr << "containers_constexpr needs fork / wait4\n";
+    return 2;
+#endif
+}
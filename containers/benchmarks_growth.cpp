@@ -0,0 +1,245 @@
+// benchmarks_growth.cpp : compares real::vector expansion policies on a replayable size trace
+//
+// usage: containers_growth [--trace=FILE | --generate=append|sawtooth|random] [--max-size=N] [--steps=N]
+//                          [--seed=N] [--save-trace=FILE] [--policy=NAME] [--csv=FILE]
+//
+// a trace is a list of target sizes (whitespace separated, # starts a comment), the vector grows to each
+//  one with emplace_back_with_policy<Policy> and shrinks with pop_back
+// for every policy one untimed replay through counting_allocator gives the peak capacity / peak size,
+//  the average capacity / size over every operation, the peak bytes (old and new buffer while moving),
+//  the bytes moved by reallocations and the allocator calls, then nanobench times the replay with std::allocator
+// custom policies are validated by adding them to run_policies()
+#include "benchmark_options.h"
+#include "counting_allocator.h"
+#include "nanobench.h"
+#include "real_vector.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace growth {
+    using element = uint64_t;
+
+    struct options {
+        std::string trace;
+        std::string generate  = "sawtooth";
+        size_t      max_size  = 100000;
+        size_t      steps     = 64;
+        uint64_t    seed      = 42;
+        std::string save_trace;
+        std::string policy;
+        std::string csv;
+    };
+
+    struct report {
+        double peak_ratio      = 0.0; // peak capacity / peak size
+        double average_ratio   = 0.0; // capacity / size averaged over every push and pop
+        size_t peak_bytes      = 0;
+        size_t bytes_moved     = 0;
+        size_t allocator_calls = 0;
+        size_t reallocations   = 0;
+        size_t operations      = 0;
+        double ns_per_trace    = 0.0;
+    };
+
+    bool load_trace(const std::string &path, std::vector<size_t> &trace) {
+        std::ifstream in;
+        if (!benchmark_options::open_file(in, path))
+            return false;
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream values(line.substr(0, line.find('#')));
+            size_t             size = 0;
+            while (values >> size)
+                trace.push_back(size);
+        }
+        return true;
+    }
+
+    bool save_trace(const std::string &path, const std::vector<size_t> &trace) {
+        std::ofstream out;
+        if (!benchmark_options::open_file(out, path))
+            return false;
+        for (size_t size : trace)
+            out << size << "\n";
+        return true;
+    }
+
+    // append: one growth to max_size
+    // sawtooth: grows to a random size, shrinks to a random fraction of it, steps times
+    // random: steps independent random target sizes
+    bool generate_trace(const options &opts, std::vector<size_t> &trace) {
+        ankerl::nanobench::Rng rng(opts.seed);
+        const auto             bounded = [&](size_t bound) {
+            return static_cast<size_t>(rng.bounded(static_cast<uint32_t>(bound + 1)));
+        };
+        if (opts.generate == "append") {
+            trace.push_back(opts.max_size);
+        } else if (opts.generate == "sawtooth") {
+            size_t size = 0;
+            for (size_t i = 0; i < opts.steps; i++) {
+                size += bounded(opts.max_size - size);
+                trace.push_back(size);
+                size = size * rng.uniform01();
+                trace.push_back(size);
+            }
+        } else if (opts.generate == "random") {
+            for (size_t i = 0; i < opts.steps; i++)
+                trace.push_back(bounded(opts.max_size));
+        } else {
+            std::cerr << "unknown trace generator " << opts.generate << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    // probe sees the vector after every push and pop
+    template <typename Policy, typename Vector, typename Probe>
+    void replay(Vector &values, const std::vector<size_t> &trace, Probe &&probe) {
+        for (size_t target : trace) {
+            while (values.size() < target) {
+                values.template emplace_back_with_policy<Policy>(values.size());
+                probe(values);
+            }
+            while (values.size() > target) {
+                values.pop_back();
+                probe(values);
+            }
+        }
+    }
+
+    template <typename Policy> report explore(const std::vector<size_t> &trace) {
+        report                       result;
+        containers::allocation_stats stats;
+        {
+            real::vector<element, containers::counting_allocator<element>> values{
+                containers::counting_allocator<element>(stats)};
+            size_t capacity      = 0;
+            size_t size          = 0;
+            size_t peak_capacity = 0;
+            size_t peak_size     = 0;
+            double ratio_sum     = 0.0;
+            replay<Policy>(values, trace, [&](const auto &v) {
+                if (v.capacity() != capacity && v.size() > size)
+                    result.bytes_moved += size * sizeof(element);
+                capacity      = v.capacity();
+                size          = v.size();
+                peak_capacity = capacity > peak_capacity ? capacity : peak_capacity;
+                peak_size     = size > peak_size ? size : peak_size;
+                ratio_sum += size ? static_cast<double>(capacity) / size : 0.0;
+                result.operations++;
+            });
+            result.peak_ratio    = peak_size ? static_cast<double>(peak_capacity) / peak_size : 0.0;
+            result.average_ratio = result.operations ? ratio_sum / result.operations : 0.0;
+        }
+        result.peak_bytes      = stats.peak_bytes;
+        result.allocator_calls = stats.allocations + stats.deallocations;
+        result.reallocations   = stats.reallocations;
+
+        ankerl::nanobench::Bench bench;
+        bench.output(nullptr);
+        bench.epochs(3);
+        bench.warmup(1);
+        bench.run("replay", [&]() {
+            real::vector<element> values;
+            replay<Policy>(values, trace, [](const auto &) {});
+            ankerl::nanobench::doNotOptimizeAway(values.data());
+        });
+        result.ns_per_trace = bench.results().back().median(ankerl::nanobench::Result::Measure::elapsed) * 1e9;
+        return result;
+    }
+
+    struct printer {
+        std::ofstream csv;
+
+        void header() {
+            std::printf("| peak cap/size | avg cap/size |   peak bytes |      bytes moved | allocator calls |"
+                        " reallocations |         ns/trace | policy\n"
+                        "|--------------:|-------------:|-------------:|-----------------:|----------------:|"
+                        "--------------:|-----------------:|:------\n");
+            if (csv.is_open())
+                csv << "\"policy\";\"peak cap/size\";\"avg cap/size\";\"peak bytes\";\"bytes moved\";"
+                       "\"allocator calls\";\"reallocations\";\"ns/trace\"\n";
+        }
+
+        void row(const char *name, const report &r) {
+            std::printf("| %13.3f | %12.3f | %12zu | %16zu | %15zu | %13zu | %16.1f | `%s`\n", r.peak_ratio,
+                        r.average_ratio, r.peak_bytes, r.bytes_moved, r.allocator_calls, r.reallocations,
+                        r.ns_per_trace, name);
+            if (csv.is_open())
+                csv << '"' << name << "\";" << r.peak_ratio << ';' << r.average_ratio << ';' << r.peak_bytes << ';'
+                    << r.bytes_moved << ';' << r.allocator_calls << ';' << r.reallocations << ';' << r.ns_per_trace
+                    << "\n";
+        }
+    };
+
+    template <typename Policy>
+    void run_policy(const char *name, const options &opts, const std::vector<size_t> &trace, printer &out) {
+        if (!opts.policy.empty() && opts.policy != name)
+            return;
+        out.row(name, explore<Policy>(trace));
+    }
+
+    void run_policies(const options &opts, const std::vector<size_t> &trace, printer &out) {
+        run_policy<real::geometric_int_expansion_policy<2>>("geometric_int_expansion_policy<2>", opts, trace, out);
+        run_policy<real::geometric_int_expansion_policy<3>>("geometric_int_expansion_policy<3>", opts, trace, out);
+        run_policy<real::geometric_double_expansion_policy<1.5>>("geometric_double_expansion_policy<1.5>", opts,
+                                                                 trace, out);
+        run_policy<real::geometric_double_expansion_policy<1.25>>("geometric_double_expansion_policy<1.25>", opts,
+                                                                  trace, out);
+        // quadratic on append heavy traces, only run when asked for
+        if (opts.policy == "default_expansion_policy")
+            run_policy<real::default_expansion_policy>("default_expansion_policy", opts, trace, out);
+    }
+} // namespace growth
+
+int main(int argc, char **argv) {
+    growth::options opts;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        std::string       value;
+        if (benchmark_options::parse_option(arg, "trace", value)) {
+            opts.trace = value;
+        } else if (benchmark_options::parse_option(arg, "generate", value)) {
+            opts.generate = value;
+        } else if (benchmark_options::parse_option(arg, "max-size", value)) {
+            opts.max_size = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (benchmark_options::parse_option(arg, "steps", value)) {
+            opts.steps = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (benchmark_options::parse_option(arg, "seed", value)) {
+            opts.seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (benchmark_options::parse_option(arg, "save-trace", value)) {
+            opts.save_trace = value;
+        } else if (benchmark_options::parse_option(arg, "policy", value)) {
+            opts.policy = value;
+        } else if (benchmark_options::parse_option(arg, "csv", value)) {
+            opts.csv = value;
+        } else {
+            std::cerr << "usage: " << argv[0]
+                      << " [--trace=FILE | --generate=append|sawtooth|random] [--max-size=N] [--steps=N]"
+                         " [--seed=N] [--save-trace=FILE] [--policy=NAME] [--csv=FILE]\n";
+            return 2;
+        }
+    }
+
+    std::vector<size_t> trace;
+    if (!opts.trace.empty() ? !growth::load_trace(opts.trace, trace) : !growth::generate_trace(opts, trace))
+        return 2;
+    if (!opts.save_trace.empty() && !growth::save_trace(opts.save_trace, trace))
+        return 2;
+
+    growth::printer out;
+    if (!opts.csv.empty()) {
+        if (!benchmark_options::open_file(out.csv, opts.csv))
+            return 2;
+    }
+    std::printf("%zu trace steps, %zu byte elements\n\n", trace.size(), sizeof(growth::element));
+    out.header();
+    growth::run_policies(opts, trace, out);
+    return 0;
+}
@@ -0,0 +1,258 @@
+// benchmarks_latency.cpp : per operation latency percentiles of emplace_back, to expose reallocation spikes
+//
+// usage: containers_latency [--size=N] [--rounds=N] [--clock=steady|tsc] [--container=NAME] [--csv=FILE]
+//
+// every round grows a fresh container to --size with emplace_back, timing each call on its own, the timings go
+//  into a log-linear histogram (HDR style, 32 sub-buckets per power of two, within ~3%) per container and growth
+//  policy, reported as p50 / p99 / p99.9 / max
+// --clock=steady reads clock_gettime through std::chrono::steady_clock, --clock=tsc reads rdtsc (x86 only,
+//  calibrated against steady_clock), the median cost of reading the clock twice is printed and not subtracted
+#include "benchmark_options.h"
+#include "nanobench.h"
+#include "real_vector.h"
+#include "stable_stack.h"
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CONTAINERS_LATENCY_TSC 1
+#endif
+
+namespace latency {
+    using element = uint64_t;
+
+    struct options {
+        size_t      size   = 1 << 20;
+        size_t      rounds = 8;
+        std::string clock  = "steady";
+        std::string container;
+        std::string csv;
+    };
+
+    // values below 2^sub_bits are exact, above that each power of two splits into 2^sub_bits buckets
+    struct histogram {
+        static constexpr unsigned sub_bits    = 5;
+        static constexpr size_t   sub_buckets = size_t{1} << sub_bits;
+        static constexpr size_t   buckets     = (64 - sub_bits + 1) * sub_buckets;
+
+        std::vector<uint64_t> counts = std::vector<uint64_t>(buckets);
+        uint64_t              total  = 0;
+        uint64_t              sum    = 0;
+        uint64_t              max    = 0;
+
+        static size_t index(uint64_t value) noexcept {
+            if (value < sub_buckets)
+                return static_cast<size_t>(value);
+            const unsigned shift = static_cast<unsigned>(std::bit_width(value)) - 1 - sub_bits;
+            return (shift + 1) * sub_buckets + static_cast<size_t>((value >> shift) - sub_buckets);
+        }
+
+        // the highest value that lands in bucket i
+        static uint64_t highest(size_t i) noexcept {
+            if (i < sub_buckets)
+                return i;
+            const unsigned shift = static_cast<unsigned>(i / sub_buckets) - 1;
+            const uint64_t top   = i % sub_buckets + sub_buckets;
+            return ((top + 1) << shift) - 1;
+        }
+
+        void record(uint64_t value) noexcept {
+            counts[index(value)]++;
+            total++;
+            sum += value;
+            max = value > max ? value : max;
+        }
+
+        // the smallest bucket bound at or above fraction of the samples (clamped to max)
+        uint64_t percentile(double fraction) const noexcept {
+            const uint64_t rank = static_cast<uint64_t>(fraction * total + 0.5);
+            uint64_t       seen = 0;
+            for (size_t i = 0; i < buckets; i++) {
+                seen += counts[i];
+                if (seen >= rank && seen)
+                    return highest(i) < max ? highest(i) : max;
+            }
+            return max;
+        }
+
+        double mean() const noexcept {
+            return total ? static_cast<double>(sum) / total : 0.0;
+        }
+    };
+
+    struct steady_timer {
+        static uint64_t now() noexcept {
+            return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+        }
+        static double ns_per_tick() noexcept {
+            return std::chrono::steady_clock::period::num * 1e9 / std::chrono::steady_clock::period::den;
+        }
+    };
+
+#if CONTAINERS_LATENCY_TSC
+    struct tsc_timer {
+        static uint64_t now() noexcept {
+            return __rdtsc();
+        }
+        // measured once over ~50ms
+        static double ns_per_tick() noexcept {
+            static const double ratio = []() {
+                const auto     start_time  = std::chrono::steady_clock::now();
+                const uint64_t start_ticks = __rdtsc();
+                while (std::chrono::steady_clock::now() - start_time < std::chrono::milliseconds(50)) {
+                }
+                const uint64_t ticks   = __rdtsc() - start_ticks;
+                const double   elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() -
+                                                                                  start_time)
+                                           .count();
+                return ticks ? elapsed / ticks : 1.0;
+            }();
+            return ratio;
+        }
+    };
+#endif
+
+    struct row {
+        std::string container;
+        double      p50  = 0.0; // ns
+        double      p99  = 0.0;
+        double      p999 = 0.0;
+        double      max  = 0.0;
+        double      mean = 0.0;
+    };
+
+    struct printer {
+        std::ofstream csv;
+
+        void header(double overhead) {
+            std::printf("two clock reads take ~%.1f ns (included below)\n\n", overhead);
+            std::printf("|       p50 ns |       p99 ns |     p99.9 ns |         max ns |      mean ns | container\n"
+                        "|-------------:|-------------:|-------------:|---------------:|-------------:|:---------\n");
+            if (csv.is_open())
+                csv << "\"container\";\"p50 ns\";\"p99 ns\";\"p99.9 ns\";\"max ns\";\"mean ns\"\n";
+        }
+
+        void print(const row &r) {
+            std::printf("| %12.1f | %12.1f | %12.1f | %14.1f | %12.1f | `%s`\n", r.p50, r.p99, r.p999, r.max, r.mean,
+                        r.container.c_str());
+            if (csv.is_open())
+                csv << '"' << r.container << "\";" << r.p50 << ';' << r.p99 << ';' << r.p999 << ';' << r.max << ';'
+                    << r.mean << "\n";
+        }
+    };
+
+    // median of back to back clock reads, the floor under every sample
+    template <typename Timer> double timer_overhead() {
+        histogram samples;
+        for (size_t i = 0; i < 100000; i++) {
+            const uint64_t before = Timer::now();
+            const uint64_t after  = Timer::now();
+            samples.record(after - before);
+        }
+        return samples.percentile(0.5) * Timer::ns_per_tick();
+    }
+
+    // times every push into a fresh Container, destruction stays outside the timed region
+    template <typename Timer, typename Container, typename Push>
+    void run(const char *name, const options &opts, printer &out, Push push) {
+        if (!opts.container.empty() && opts.container != name)
+            return;
+        histogram samples;
+        for (size_t r = 0; r < opts.rounds; r++) {
+            Container values;
+            for (size_t i = 0; i < opts.size; i++) {
+                const uint64_t before = Timer::now();
+                push(values, i);
+                const uint64_t after = Timer::now();
+                samples.record(after - before);
+            }
+            ankerl::nanobench::doNotOptimizeAway(values.size());
+        }
+        const double scale = Timer::ns_per_tick();
+        row          result;
+        result.container = name;
+        result.p50       = samples.percentile(0.5) * scale;
+        result.p99       = samples.percentile(0.99) * scale;
+        result.p999      = samples.percentile(0.999) * scale;
+        result.max       = samples.max * scale;
+        result.mean      = samples.mean() * scale;
+        out.print(result);
+    }
+
+    template <typename Policy> struct with_policy {
+        template <typename Vector> void operator()(Vector &values, element value) const {
+            values.template emplace_back_with_policy<Policy>(value);
+        }
+    };
+
+    template <typename Timer> void run_containers(const options &opts, printer &out) {
+        out.header(timer_overhead<Timer>());
+        const auto emplace = [](auto &values, element value) { values.emplace_back(value); };
+        run<Timer, std::vector<element>>("std::vector", opts, out, emplace);
+        run<Timer, std::deque<element>>("std::deque", opts, out, emplace);
+        run<Timer, real::vector<element>>("real::vector", opts, out, emplace);
+        run<Timer, real::vector<element>>("real::vector reserved", opts, out, [&](auto &values, element value) {
+            if (!value)
+                values.reserve(opts.size);
+            values.emplace_back(value);
+        });
+        run<Timer, real::vector<element>>("real::vector geometric_int_expansion_policy<3>", opts, out,
+                                          with_policy<real::geometric_int_expansion_policy<3>>{});
+        run<Timer, real::vector<element>>("real::vector geometric_double_expansion_policy<1.5>", opts, out,
+                                          with_policy<real::geometric_double_expansion_policy<1.5>>{});
+        run<Timer, real::vector<element>>("real::vector geometric_double_expansion_policy<1.25>", opts, out,
+                                          with_policy<real::geometric_double_expansion_policy<1.25>>{});
+        run<Timer, stable_stack<element, 32>>("stable_stack<32>", opts, out, emplace);
+        run<Timer, stable_stack<element, 1024>>("stable_stack<1024>", opts, out, emplace);
+    }
+} // namespace latency
+
+int main(int argc, char **argv) {
+    latency::options opts;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        std::string       value;
+        if (benchmark_options::parse_option(arg, "size", value)) {
+            opts.size = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (benchmark_options::parse_option(arg, "rounds", value)) {
+            opts.rounds = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (benchmark_options::parse_option(arg, "clock", value)) {
+            opts.clock = value;
+        } else if (benchmark_options::parse_option(arg, "container", value)) {
+            opts.container = value;
+        } else if (benchmark_options::parse_option(arg, "csv", value)) {
+            opts.csv = value;
+        } else {
+            std::cerr << "usage: " << argv[0]
+                      << " [--size=N] [--rounds=N] [--clock=steady|tsc] [--container=NAME] [--csv=FILE]\n";
+            return 2;
+        }
+    }
+
+    latency::printer out;
+    if (!opts.csv.empty()) {
+        if (!benchmark_options::open_file(out.csv, opts.csv))
+            return 2;
+    }
+    std::printf("%zu rounds of %zu emplace_back's, %s clock\n", opts.rounds, opts.size, opts.clock.c_str());
+    if (opts.clock == "steady") {
+        latency::run_containers<latency::steady_timer>(opts, out);
+#if CONTAINERS_LATENCY_TSC
+    } else if (opts.clock == "tsc") {
+        latency::run_containers<latency::tsc_timer>(opts, out);
+#endif
+    } else {
+        std::cerr << "unknown clock " << opts.clock << "\n";
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,343 @@
+// benchmarks_replay.cpp : replays a recorded (or synthetic) trace of vector operations against every container
+//
+// usage: containers_replay [--trace=FILE | --generate=N] [--seed=N] [--max-size=N] [--mix=WEIGHTS]
+//                          [--save-trace=FILE] [--container=NAME] [--csv=FILE]
+//
+// traces come from real::trace_instrumentation (vector_trace.h has the format), or --generate=N makes N operations
+//  with nanobench's Rng, picking each one by --mix weights (push:60,pop:20,insert:8,erase:8,reserve:2,clear:2)
+//  and keeping the size within --max-size
+// every replay starts from an empty container and is deterministic, nanobench reports the time per operation
+// plain_array needs the trace's peak size to fit its capacity, stable_stack only replays traces without
+//  inserts or erases away from the back, containers that cannot replay the trace are skipped
+#include "benchmark_options.h"
+#include "nanobench.h"
+#include "plain_array.h"
+#include "real_vector.h"
+#include "stable_stack.h"
+#include "vector_trace.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace replay {
+    using element = uint64_t;
+
+    inline constexpr size_t plain_array_capacity = 16384;
+
+    inline constexpr const char *op_names[] = {"push", "pop", "insert", "erase", "reserve", "clear"};
+
+    struct options {
+        std::string trace;
+        size_t      generate = 0;
+        uint64_t    seed     = 42;
+        size_t      max_size = 4096;
+        size_t      weights[6] = {60, 20, 8, 8, 2, 2}; // in trace_op_kind order
+        std::string save_trace;
+        std::string container;
+        std::string csv;
+    };
+
+    struct summary {
+        size_t peak_size = 0;
+        bool   middle    = false; // inserts or erases away from the back
+    };
+
+    summary summarize(const real::vector_trace &trace) {
+        summary result;
+        size_t  size = 0;
+        for (const real::trace_op &op : trace) {
+            switch (op.kind) {
+            case real::trace_op_kind::push:
+                size++;
+                break;
+            case real::trace_op_kind::pop:
+                size--;
+                break;
+            case real::trace_op_kind::insert:
+                result.middle |= op.pos != size;
+                size += op.count;
+                break;
+            case real::trace_op_kind::erase:
+                result.middle |= op.pos + op.count != size;
+                size -= op.count;
+                break;
+            case real::trace_op_kind::reserve:
+                break;
+            case real::trace_op_kind::clear:
+                size = 0;
+                break;
+            }
+            result.peak_size = size > result.peak_size ? size : result.peak_size;
+        }
+        return result;
+    }
+
+    // "push:60,pop:20" style, unnamed operations keep their weight
+    bool parse_mix(const std::string &mix, size_t (&weights)[6]) {
+        size_t start = 0;
+        while (start < mix.size()) {
+            size_t            end   = mix.find(',', start);
+            const std::string entry = mix.substr(start, end == std::string::npos ? std::string::npos : end - start);
+            const size_t      colon = entry.find(':');
+            bool              found = false;
+            for (size_t k = 0; colon != std::string::npos && k < std::size(op_names); k++) {
+                if (entry.compare(0, colon, op_names[k]) == 0) {
+                    weights[k] = std::strtoull(entry.c_str() + colon + 1, nullptr, 10);
+                    found      = true;
+                }
+            }
+            if (!found) {
+                std::cerr << "unknown --mix entry " << entry << "\n";
+                return false;
+            }
+            start = end == std::string::npos ? mix.size() : end + 1;
+        }
+        return true;
+    }
+
+    // operations that would leave [0, max_size] become pushes or pops
+    real::vector_trace generate_trace(const options &opts) {
+        ankerl::nanobench::Rng rng(opts.seed);
+        const auto             bounded = [&](size_t bound) {
+            return static_cast<size_t>(rng.bounded(static_cast<uint32_t>(bound + 1)));
+        };
+        size_t total = 0;
+        for (size_t weight : opts.weights)
+            total += weight;
+
+        real::vector_trace trace;
+        size_t             size = 0;
+        for (size_t i = 0; i < opts.generate; i++) {
+            size_t pick = total ? bounded(total - 1) : 0;
+            size_t kind = 0;
+            while (kind + 1 < std::size(opts.weights) && pick >= opts.weights[kind])
+                pick -= opts.weights[kind++];
+
+            real::trace_op op{static_cast<real::trace_op_kind>(kind), 0, 1};
+            switch (op.kind) {
+            case real::trace_op_kind::insert:
+                op.count = 1 + bounded(opts.max_size / 64);
+                op.pos   = bounded(size);
+                break;
+            case real::trace_op_kind::erase: {
+                const size_t most = size < opts.max_size / 64 + 1 ? size : opts.max_size / 64 + 1;
+                op.count          = most ? 1 + bounded(most - 1) : 1;
+                op.pos            = size >= op.count ? bounded(size - op.count) : 0;
+                break;
+            }
+            case real::trace_op_kind::reserve:
+                op.count = size + bounded(opts.max_size - size);
+                break;
+            default:
+                break;
+            }
+            if ((op.kind == real::trace_op_kind::pop || op.kind == real::trace_op_kind::erase) && size < op.count)
+                op = {real::trace_op_kind::push, size, 1};
+            if ((op.kind == real::trace_op_kind::push || op.kind == real::trace_op_kind::insert) &&
+                size + op.count > opts.max_size)
+                op = {real::trace_op_kind::pop, size - 1, 1};
+
+            switch (op.kind) {
+            case real::trace_op_kind::push:
+                op.pos = size;
+                size++;
+                break;
+            case real::trace_op_kind::pop:
+                op.pos = --size;
+                break;
+            case real::trace_op_kind::insert:
+                size += op.count;
+                break;
+            case real::trace_op_kind::erase:
+                size -= op.count;
+                break;
+            case real::trace_op_kind::reserve:
+                break;
+            case real::trace_op_kind::clear:
+                op.count = size;
+                size     = 0;
+                break;
+            }
+            trace.push_back(op);
+        }
+        return trace;
+    }
+
+    // Policy is the expansion policy push uses (void for push_back), reserve is a no-op without reserve()
+    template <typename Policy = void, typename Container>
+    void apply(Container &values, const real::trace_op &op, element value) {
+        switch (op.kind) {
+        case real::trace_op_kind::push:
+            if constexpr (std::is_void_v<Policy>)
+                values.push_back(value);
+            else
+                values.template push_back_with_policy<Policy>(value);
+            break;
+        case real::trace_op_kind::pop:
+            values.pop_back();
+            break;
+        case real::trace_op_kind::insert:
+            values.insert(values.begin() + op.pos, op.count, value);
+            break;
+        case real::trace_op_kind::erase:
+            values.erase(values.begin() + op.pos, values.begin() + (op.pos + op.count));
+            break;
+        case real::trace_op_kind::reserve:
+            if constexpr (requires { values.reserve(op.count); })
+                values.reserve(op.count);
+            break;
+        case real::trace_op_kind::clear:
+            values.clear();
+            break;
+        }
+    }
+
+    // stable_stack only has the back: inserts push, erases and clear pop
+    template <typename T, size_t N> void apply(stable_stack<T, N> &values, const real::trace_op &op, element value) {
+        switch (op.kind) {
+        case real::trace_op_kind::push:
+            values.push_back(value);
+            break;
+        case real::trace_op_kind::insert:
+            for (size_t i = 0; i < op.count; i++)
+                values.push_back(value);
+            break;
+        case real::trace_op_kind::pop:
+        case real::trace_op_kind::erase:
+        case real::trace_op_kind::clear:
+            for (size_t i = 0; i < op.count; i++)
+                values.pop_back();
+            break;
+        case real::trace_op_kind::reserve:
+            values.reserve(op.count);
+            break;
+        }
+    }
+
+    template <typename Container, typename Policy = void>
+    void run(ankerl::nanobench::Bench &bench, const char *name, const options &opts, const real::vector_trace &trace) {
+        if (!opts.container.empty() && opts.container != name)
+            return;
+        bench.run(name, [&]() {
+            std::unique_ptr<Container> values = std::make_unique<Container>();
+            for (size_t i = 0; i < trace.size(); i++)
+                apply<Policy>(*values, trace[i], i);
+            ankerl::nanobench::doNotOptimizeAway(values->size());
+        });
+    }
+
+    template <typename T, size_t N>
+    void run_stable_stack(ankerl::nanobench::Bench &bench, const char *name, const options &opts,
+                          const real::vector_trace &trace) {
+        if (!opts.container.empty() && opts.container != name)
+            return;
+        bench.run(name, [&]() {
+            stable_stack<T, N> values;
+            for (size_t i = 0; i < trace.size(); i++)
+                apply(values, trace[i], i);
+            ankerl::nanobench::doNotOptimizeAway(values.size());
+        });
+    }
+
+    void run_containers(ankerl::nanobench::Bench &bench, const options &opts, const real::vector_trace &trace) {
+        const summary info = summarize(trace);
+        run<std::vector<element>>(bench, "std::vector", opts, trace);
+        run<real::vector<element>>(bench, "real::vector", opts, trace);
+        run<real::vector<element>, real::geometric_double_expansion_policy<1.5>>(
+            bench, "real::vector (push_back_with_policy<geometric_double_expansion_policy<1.5>>)", opts, trace);
+        if (info.peak_size <= plain_array_capacity)
+            run<containers::plain_array<element, plain_array_capacity>>(bench, "containers::plain_array", opts,
+                                                                         trace);
+        else
+            std::printf("skipping containers::plain_array, the trace peaks at %zu values\n", info.peak_size);
+        if (!info.middle)
+            run_stable_stack<element, 32>(bench, "stable_stack", opts, trace);
+        else
+            std::printf("skipping stable_stack, the trace inserts or erases away from the back\n");
+    }
+} // namespace replay
+
+int main(int argc, char **argv) {
+    replay::options opts;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        std::string       value;
+        if (benchmark_options::parse_option(arg, "trace", value)) {
+            opts.trace = value;
+        } else if (benchmark_options::parse_option(arg, "generate", value)) {
+            opts.generate = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (benchmark_options::parse_option(arg, "seed", value)) {
+            opts.seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (benchmark_options::parse_option(arg, "max-size", value)) {
+            opts.max_size = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (benchmark_options::parse_option(arg, "mix", value)) {
+            if (!replay::parse_mix(value, opts.weights))
+                return 2;
+        } else if (benchmark_options::parse_option(arg, "save-trace", value)) {
+            opts.save_trace = value;
+        } else if (benchmark_options::parse_option(arg, "container", value)) {
+            opts.container = value;
+        } else if (benchmark_options::parse_option(arg, "csv", value)) {
+            opts.csv = value;
+        } else {
+            std::cerr << "usage: " << argv[0]
+                      << " [--trace=FILE | --generate=N] [--seed=N] [--max-size=N] [--mix=WEIGHTS]"
+                         " [--save-trace=FILE] [--container=NAME] [--csv=FILE]\n";
+            return 2;
+        }
+    }
+    // generate_trace bounds every op by max_size, 0 would wrap them
+    if (!opts.max_size) {
+        std::cerr << "--max-size must be at least 1\n";
+        return 2;
+    }
+
+    real::vector_trace trace;
+    if (!opts.trace.empty()) {
+        std::ifstream in;
+        std::string   error;
+        if (!benchmark_options::open_file(in, opts.trace))
+            return 2;
+        if (!real::read_trace(in, trace, error)) {
+            std::cerr << opts.trace << ": " << error << "\n";
+            return 2;
+        }
+    } else {
+        if (!opts.generate)
+            opts.generate = 100000;
+        trace = replay::generate_trace(opts);
+    }
+    if (trace.empty()) {
+        std::cerr << "the trace is empty\n";
+        return 2;
+    }
+    if (!opts.save_trace.empty()) {
+        std::ofstream out;
+        if (!benchmark_options::open_file(out, opts.save_trace))
+            return 2;
+        real::write_trace(out, trace);
+    }
+
+    ankerl::nanobench::Bench bench;
+    bench.title("replay of " + std::to_string(trace.size()) + " operations");
+    bench.unit("op");
+    bench.batch(trace.size());
+    bench.warmup(1);
+    bench.relative(true);
+    replay::run_containers(bench, opts, trace);
+
+    if (!opts.csv.empty()) {
+        std::ofstream out;
+        if (!benchmark_options::open_file(out, opts.csv))
+            return 2;
+        ankerl::nanobench::render(ankerl::nanobench::templates::csv(), bench, out);
+    }
+    return 0;
+}
@@ -0,0 +1,334 @@
+// benchmarks_threads.cpp : throughput of container usage patterns from 1 thread up to every core
+//
+// usage: containers_threads [--threads=N] [--ops=N] [--size=N] [--workload=NAME] [--csv=FILE]
+//
+// workloads (every thread does --ops operations per round, the median of 5 rounds is reported):
+//  vector/new_delete        each thread grows its own pmr::real::vector to --size and drops it,
+//                           every vector allocates from new_delete_resource()
+//  vector/synchronized_pool the same, all threads share one synchronized_pool_resource
+//  vector/per_thread_pool   the same, each thread has its own unsynchronized_pool_resource (no contention)
+//  vector/thread_cache      the same, all threads share one thread_cache_resource (per thread free lists)
+//  stable_stack/read_while_append
+//                           thread 0 appends to a shared stable_stack, the others read published elements
+//  plain_array/adjacent     each thread push_back's into its own small plain_array, the arrays are packed
+//                           next to each other (false sharing)
+//  plain_array/padded       the same with every array on its own cache line
+//  mpmc_ring_buffer/push_pop
+//                           all threads share one mpmc_ring_buffer, each pushes up to 16 values and pops up to 16
+//                           in turn
+// thread counts double from 1 up to --threads (default every core), the last count is always --threads
+#include "benchmark_options.h"
+#include "nanobench.h"
+#include "plain_array.h"
+#include "real_vector.h"
+#include "ring_buffer.h"
+#include "stable_stack.h"
+#include "thread_cache_resource.h"
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace threads {
+    struct options {
+        size_t      threads = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+        size_t      ops     = 1 << 16;
+        size_t      size    = 1024;
+        std::string workload;
+        std::string csv;
+    };
+
+#ifdef __cpp_lib_hardware_interference_size
+    inline constexpr size_t cache_line = std::hardware_destructive_interference_size;
+#else
+    inline constexpr size_t cache_line = 64;
+#endif
+
+    // count workers that run work(thread index) once per round, the caller only starts and joins rounds
+    struct worker_pool {
+        std::function<void(size_t)> work;
+        std::barrier<>              start;
+        std::barrier<>              done;
+        bool                        stop = false;
+        std::vector<std::thread>    workers;
+
+        worker_pool(size_t count, std::function<void(size_t)> fn)
+            : work(std::move(fn)), start(static_cast<std::ptrdiff_t>(count + 1)),
+              done(static_cast<std::ptrdiff_t>(count + 1)) {
+            for (size_t i = 0; i < count; i++) {
+                workers.emplace_back([this, i]() {
+                    for (;;) {
+                        start.arrive_and_wait();
+                        if (stop)
+                            return;
+                        work(i);
+                        done.arrive_and_wait();
+                    }
+                });
+            }
+        }
+
+        worker_pool(const worker_pool &)            = delete;
+        worker_pool &operator=(const worker_pool &) = delete;
+
+        ~worker_pool() {
+            stop = true;
+            start.arrive_and_wait();
+            for (std::thread &worker : workers)
+                worker.join();
+        }
+
+        void round() {
+            start.arrive_and_wait();
+            done.arrive_and_wait();
+        }
+    };
+
+    struct row {
+        std::string workload;
+        size_t      threads    = 0;
+        double      ops_per_s  = 0.0;
+        double      speedup    = 0.0;
+        double      efficiency = 0.0;
+    };
+
+    // times rounds of the pool and keeps the median, before_round runs on the calling thread while the workers
+    //  wait and stays outside the timed region (nanobench would time it along with the round)
+    row measure(const std::string &workload, size_t count, size_t ops_per_round, worker_pool &pool,
+                const std::function<void()> &before_round = {}) {
+        constexpr size_t    warmup = 1;
+        constexpr size_t    rounds = 5;
+        std::vector<double> seconds;
+        for (size_t r = 0; r < warmup + rounds; r++) {
+            if (before_round)
+                before_round();
+            const auto start = std::chrono::steady_clock::now();
+            pool.round();
+            const auto stop = std::chrono::steady_clock::now();
+            if (r >= warmup)
+                seconds.push_back(std::chrono::duration<double>(stop - start).count());
+        }
+        std::nth_element(seconds.begin(), seconds.begin() + rounds / 2, seconds.end());
+        row result;
+        result.workload  = workload;
+        result.threads   = count;
+        result.ops_per_s = ops_per_round / seconds[rounds / 2];
+        return result;
+    }
+
+    using element = uint64_t;
+
+    // grows a vector to size from scratch, ops / size times, every growth goes to resource
+    void grow_vectors(std::pmr::memory_resource *resource, size_t ops, size_t size) {
+        for (size_t done = 0; done < ops; done += size) {
+            pmr::real::vector<element> values{std::pmr::polymorphic_allocator<element>(resource)};
+            for (size_t i = 0; i < size; i++)
+                values.push_back(i);
+            ankerl::nanobench::doNotOptimizeAway(values.data());
+        }
+    }
+
+    row vector_new_delete(const options &opts, size_t count) {
+        worker_pool pool(count, [&](size_t) { grow_vectors(std::pmr::new_delete_resource(), opts.ops, opts.size); });
+        return measure("vector/new_delete", count, count * opts.ops, pool);
+    }
+
+    row vector_synchronized_pool(const options &opts, size_t count) {
+        std::pmr::synchronized_pool_resource shared(std::pmr::new_delete_resource());
+        worker_pool pool(count, [&](size_t) { grow_vectors(&shared, opts.ops, opts.size); });
+        return measure("vector/synchronized_pool", count, count * opts.ops, pool);
+    }
+
+    row vector_per_thread_pool(const options &opts, size_t count) {
+        std::vector<std::unique_ptr<std::pmr::unsynchronized_pool_resource>> resources;
+        for (size_t i = 0; i < count; i++)
+            resources.push_back(
+                std::make_unique<std::pmr::unsynchronized_pool_resource>(std::pmr::new_delete_resource()));
+        worker_pool pool(count, [&](size_t i) { grow_vectors(resources[i].get(), opts.ops, opts.size); });
+        return measure("vector/per_thread_pool", count, count * opts.ops, pool);
+    }
+
+    row vector_thread_cache(const options &opts, size_t count) {
+        containers::thread_cache_resource shared(std::pmr::new_delete_resource());
+        worker_pool pool(count, [&](size_t) { grow_vectors(&shared, opts.ops, opts.size); });
+        return measure("vector/thread_cache", count, count * opts.ops, pool);
+    }
+
+    // stable_stack is not thread safe, this relies on the block list being reserved up front
+    //  (so the writer never moves it) and on readers only touching elements published through size
+    row stable_stack_read_while_append(const options &opts, size_t count) {
+        std::unique_ptr<stable_stack<element>> stack;
+        std::atomic<size_t>                    published{0};
+        worker_pool                            pool(count, [&](size_t i) {
+            if (i == 0) {
+                for (size_t v = 0; v < opts.ops; v++) {
+                    stack->push_back(v);
+                    published.store(v + 1, std::memory_order_release);
+                }
+                return;
+            }
+            // readers wait for the first publish, every op they count is a real read
+            while (opts.ops && !published.load(std::memory_order_acquire))
+                std::this_thread::yield();
+            ankerl::nanobench::Rng rng(i);
+            element                sum = 0;
+            for (size_t r = 0; r < opts.ops; r++) {
+                const size_t size = published.load(std::memory_order_acquire);
+                sum += (*stack)[rng.bounded(static_cast<uint32_t>(size))];
+            }
+            ankerl::nanobench::doNotOptimizeAway(sum);
+        });
+        return measure("stable_stack/read_while_append", count, count * opts.ops, pool, [&]() {
+            stack = std::make_unique<stable_stack<element>>();
+            stack->reserve(opts.ops);
+            published.store(0, std::memory_order_relaxed);
+        });
+    }
+
+    using small_array = containers::plain_array<uint32_t, 7>;
+
+    struct alignas(cache_line) padded_array {
+        small_array values;
+    };
+
+    template <typename Array> void fill_arrays(Array &array, size_t ops) {
+        for (size_t v = 0; v < ops; v++) {
+            if (array.size() == 7)
+                array.clear();
+            array.push_back(static_cast<uint32_t>(v));
+        }
+    }
+
+    row plain_array_adjacent(const options &opts, size_t count) {
+        std::vector<small_array> arrays(count);
+        worker_pool              pool(count, [&](size_t i) { fill_arrays(arrays[i], opts.ops); });
+        return measure("plain_array/adjacent", count, count * opts.ops, pool);
+    }
+
+    row plain_array_padded(const options &opts, size_t count) {
+        std::vector<padded_array> arrays(count);
+        worker_pool               pool(count, [&](size_t i) { fill_arrays(arrays[i].values, opts.ops); });
+        return measure("plain_array/padded", count, count * opts.ops, pool);
+    }
+
+    using mpmc_queue = containers::mpmc_ring_buffer<element, 1024>;
+
+    // every thread pushes a batch and pops whatever batch is there, a value popped by another thread counts
+    //  too, at most a queue full of values is left over for the next round
+    void push_pop_batches(mpmc_queue &queue, size_t ops) {
+        element batch[16];
+        element sum = 0;
+        for (size_t pushed = 0; pushed < ops;) {
+            const size_t count = (ops - pushed) < 16 ? (ops - pushed) : 16;
+            for (size_t i = 0; i < count; i++)
+                batch[i] = pushed + i;
+            pushed += queue.try_push_n(batch, count);
+            const size_t popped = queue.try_pop_n(batch, 16);
+            for (size_t i = 0; i < popped; i++)
+                sum += batch[i];
+        }
+        ankerl::nanobench::doNotOptimizeAway(sum);
+    }
+
+    row mpmc_ring_buffer_push_pop(const options &opts, size_t count) {
+        auto        queue = std::make_unique<mpmc_queue>();
+        worker_pool pool(count, [&](size_t) { push_pop_batches(*queue, opts.ops); });
+        return measure("mpmc_ring_buffer/push_pop", count, count * opts.ops, pool);
+    }
+
+    struct printer {
+        std::ofstream csv;
+
+        void header() {
+            std::printf("| threads |         ops/s |  speedup | efficiency | workload\n"
+                        "|--------:|--------------:|---------:|-----------:|:--------\n");
+            if (csv.is_open())
+                csv << "\"workload\";\"threads\";\"ops/s\";\"speedup\";\"efficiency\"\n";
+        }
+
+        void print(const row &r) {
+            std::printf("| %7zu | %13.0f | %8.2f | %9.1f%% | `%s`\n", r.threads, r.ops_per_s, r.speedup,
+                        r.efficiency * 100.0, r.workload.c_str());
+            if (csv.is_open())
+                csv << '"' << r.workload << "\";" << r.threads << ';' << r.ops_per_s << ';' << r.speedup << ';'
+                    << r.efficiency << "\n";
+        }
+    };
+
+    // speedup and efficiency are against the single thread row of the same workload
+    void scale(const char *name, row (*workload)(const options &, size_t), const options &opts, printer &out) {
+        if (!opts.workload.empty() && opts.workload != name)
+            return;
+        std::vector<size_t> counts;
+        for (size_t count = 1; count < opts.threads; count *= 2)
+            counts.push_back(count);
+        counts.push_back(opts.threads);
+
+        double single = 0.0;
+        for (size_t count : counts) {
+            row r = workload(opts, count);
+            if (count == 1)
+                single = r.ops_per_s;
+            r.speedup    = single ? r.ops_per_s / single : 0.0;
+            r.efficiency = r.speedup / count;
+            out.print(r);
+        }
+    }
+} // namespace threads
+
+int main(int argc, char **argv) {
+    threads::options opts;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        std::string       value;
+        if (benchmark_options::parse_option(arg, "threads", value)) {
+            opts.threads = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (benchmark_options::parse_option(arg, "ops", value)) {
+            opts.ops = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (benchmark_options::parse_option(arg, "size", value)) {
+            opts.size = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (benchmark_options::parse_option(arg, "workload", value)) {
+            opts.workload = value;
+        } else if (benchmark_options::parse_option(arg, "csv", value)) {
+            opts.csv = value;
+        } else {
+            std::cerr << "usage: " << argv[0]
+                      << " [--threads=N] [--ops=N] [--size=N] [--workload=NAME] [--csv=FILE]\n";
+            return 2;
+        }
+    }
+    if (!opts.threads || !opts.ops || !opts.size) {
+        std::cerr << "--threads, --ops and --size must be at least 1\n";
+        return 2;
+    }
+
+    threads::printer out;
+    if (!opts.csv.empty()) {
+        if (!benchmark_options::open_file(out.csv, opts.csv))
+            return 2;
+    }
+    std::printf("up to %zu threads (%u cores), %zu ops per thread, vectors grown to %zu\n\n", opts.threads,
+                std::thread::hardware_concurrency(), opts.ops, opts.size);
+    out.header();
+    threads::scale("vector/new_delete", threads::vector_new_delete, opts, out);
+    threads::scale("vector/synchronized_pool", threads::vector_synchronized_pool, opts, out);
+    threads::scale("vector/per_thread_pool", threads::vector_per_thread_pool, opts, out);
+    threads::scale("vector/thread_cache", threads::vector_thread_cache, opts, out);
+    threads::scale("stable_stack/read_while_append", threads::stable_stack_read_while_append, opts, out);
+    threads::scale("plain_array/adjacent", threads::plain_array_adjacent, opts, out);
+    threads::scale("plain_array/padded", threads::plain_array_padded, opts, out);
+    threads::scale("mpmc_ring_buffer/push_pop", threads::mpmc_ring_buffer_push_pop, opts, out);
+    return 0;
+}
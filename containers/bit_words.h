@@ -0,0 +1,159 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSVC_LANG)
+#define __cplusplus_version _MSVC_LANG
+#elif defined(__cplusplus) // ^^^ use _MSVC_LANG / use __cplusplus vvv
+#define __cplusplus_version __cplusplus
+#else // ^^^ use __cplusplus / no C++ support vvv
+#define __cplusplus_version 0L
+#endif // ^^^ no C++ support ^^^
+
+#if __cplusplus_version > 201703L && __has_include(<bit>)
+#include <bit>
+#endif
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2020 Alex Anderson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// bit_words: the word level operations behind containers::packed_bits and real::bit_vector
+//  both keep one bit per value in 64 bit words with every bit at or past size() cleared, the helpers here take
+//  the words as a pointer and a word count and rely on that
+
+namespace bit_words {
+    using word_type = ::std::uint64_t;
+    using size_type = ::std::size_t;
+
+    inline constexpr size_type word_bits = 64;
+
+    constexpr size_type popcount(word_type word) noexcept {
+#if __cpp_lib_bitops >= 201907L
+        return static_cast<size_type>(::std::popcount(word));
+#elif defined(__GNUC__) || defined(__clang__)
+        return static_cast<size_type>(__builtin_popcountll(word));
+#else
+        size_type count = 0;
+        for (; word; word &= word - 1)
+            count++;
+        return count;
+#endif
+    }
+
+    // word must not be 0
+    constexpr size_type countr_zero(word_type word) noexcept {
+#if __cpp_lib_bitops >= 201907L
+        return static_cast<size_type>(::std::countr_zero(word));
+#elif defined(__GNUC__) || defined(__clang__)
+        return static_cast<size_type>(__builtin_ctzll(word));
+#else
+        size_type count = 0;
+        for (; !(word & 1); word >>= 1)
+            count++;
+        return count;
+#endif
+    }
+
+    constexpr size_type word_index(size_type pos) noexcept {
+        return pos / word_bits;
+    }
+    constexpr word_type bit_mask(size_type pos) noexcept {
+        return word_type{1} << (pos % word_bits);
+    }
+    constexpr size_type words_for(size_type count) noexcept {
+        return (count + word_bits - 1) / word_bits;
+    }
+
+    // mask of the bits [first, last) within one word, last <= 64
+    constexpr word_type range_mask(size_type first, size_type last) noexcept {
+        const word_type high = last >= word_bits ? ~word_type{0} : ((word_type{1} << last) - 1);
+        return high & (~word_type{0} << first);
+    }
+
+    // a single bit inside a word
+    struct reference {
+        word_type *_word;
+        word_type  _mask;
+
+        constexpr operator bool() const noexcept {
+            return (*_word & _mask) != 0;
+        }
+        constexpr reference &operator=(bool value) noexcept {
+            *_word = value ? (*_word | _mask) : (*_word & ~_mask);
+            return *this;
+        }
+        constexpr reference &operator=(const reference &other) noexcept {
+            return operator=(static_cast<bool>(other));
+        }
+        constexpr void flip() noexcept {
+            *_word ^= _mask;
+        }
+    };
+
+    // sets or clears the bits [first, last), masks the edge words and writes whole words in between
+    constexpr void fill_range(word_type *words, size_type first, size_type last, bool value) noexcept {
+        if (first >= last)
+            return;
+        const size_type first_word = word_index(first);
+        const size_type last_word  = word_index(last - 1);
+        const word_type fill_word  = value ? ~word_type{0} : word_type{0};
+        for (size_type i = first_word; i <= last_word; i++) {
+            const size_type lo   = i == first_word ? first % word_bits : 0;
+            const size_type hi   = i == last_word ? ((last - 1) % word_bits) + 1 : word_bits;
+            const word_type mask = range_mask(lo, hi);
+            words[i]             = (words[i] & ~mask) | (fill_word & mask);
+        }
+    }
+
+    // number of set bits in the first word_count words
+    constexpr size_type count(const word_type *words, size_type word_count) noexcept {
+        size_type total = 0;
+        for (size_type i = 0; i < word_count; i++)
+            total += popcount(words[i]);
+        return total;
+    }
+
+    constexpr bool any(const word_type *words, size_type word_count) noexcept {
+        for (size_type i = 0; i < word_count; i++)
+            if (words[i])
+                return true;
+        return false;
+    }
+
+    // index of the first set bit at or after pos, size if there is none
+    constexpr size_type find_from(const word_type *words, size_type size, size_type pos) noexcept {
+        if (pos >= size)
+            return size;
+        const size_type word_count = words_for(size);
+        size_type       i          = word_index(pos);
+        word_type       word       = words[i] & (~word_type{0} << (pos % word_bits));
+        for (;;) {
+            if (word)
+                return i * word_bits + countr_zero(word);
+            if (++i >= word_count)
+                return size;
+            word = words[i];
+        }
+    }
+} // namespace bit_words
@@ -0,0 +1,57 @@
+// constexpr_workload.cpp : a constant evaluated plain_array workload, compiled (not run) by containers_constexpr
+//
+// -DCONSTEXPR_N=<capacity> -DCONSTEXPR_OPS=<inserts and erases> -DCONSTEXPR_WORKLOAD=<0..4>
+//  0 push_back to capacity
+//  1 insert(pos, 1, value) + erase(pos), starting half full
+//  2 insert_rotate(pos, 1, value) + erase(pos), starting half full
+//  3 insert(pos, first, last) of 4 values + erase(first, last), starting half full
+//  4 emplace(pos, value) + erase(pos), starting half full
+// angle brackets so the header comes from containers_constexpr's --include directory, never from next to this file
+#include <plain_array.h>
+#include <cstddef>
+
+#ifndef CONSTEXPR_N
+#define CONSTEXPR_N 32
+#endif
+#ifndef CONSTEXPR_OPS
+#define CONSTEXPR_OPS 32
+#endif
+#ifndef CONSTEXPR_WORKLOAD
+#define CONSTEXPR_WORKLOAD 1
+#endif
+
+constexpr size_t n   = CONSTEXPR_N;
+constexpr size_t ops = CONSTEXPR_OPS;
+
+constexpr auto table = []() {
+    containers::plain_array<int, n> values;
+    const size_t                    fill = CONSTEXPR_WORKLOAD == 0 ? n : n / 2;
+    for (size_t i = 0; i < fill; i++)
+        values.push_back(static_cast<int>(i));
+
+    const int range[4] = {-1, -2, -3, -4};
+    for (size_t i = 0; CONSTEXPR_WORKLOAD != 0 && i < ops; i++) {
+        const size_t pos = (i * 7919) % (values.size() + 1);
+        if constexpr (CONSTEXPR_WORKLOAD == 1) {
+            values.insert(values.begin() + pos, 1, static_cast<int>(i));
+            values.erase(values.begin() + (i * 104729) % values.size());
+        } else if constexpr (CONSTEXPR_WORKLOAD == 2) {
+            values.insert_rotate(values.begin() + pos, 1, static_cast<int>(i));
+            values.erase(values.begin() + (i * 104729) % values.size());
+        } else if constexpr (CONSTEXPR_WORKLOAD == 3) {
+            values.insert(values.begin() + pos, range, range + 4);
+            const size_t erase_pos = (i * 104729) % (values.size() - 3);
+            values.erase(values.begin() + erase_pos, values.begin() + erase_pos + 4);
+        } else {
+            values.emplace(values.begin() + pos, static_cast<int>(i));
+            values.erase(values.begin() + (i * 104729) % values.size());
+        }
+    }
+    return values;
+}();
+
+static_assert(table.size() == (CONSTEXPR_WORKLOAD == 0 ? n : n / 2), "the workload should leave the size unchanged");
+
+int main() {
+    return table[0];
+}
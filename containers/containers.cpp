@@ -1,9 +1,31 @@
 ﻿// containers.cpp : Defines the entry point for the application.
 //
+#include "counting_allocator.h"
+#include "inline_arena.h"
 #include "nanobench.h"
+#include "packed_bits.h"
+#include "packed_int_vector.h"
 #include "plain_array.h"
+#include "ragged_vector.h"
+#include "ring_buffer.h"
+#include "serialization.h"
+#include "simd_allocator.h"
+#include "stable_stack.h"
+#include "thin_vector.h"
+#include "vector_instrumentation.h"
+#include "vector_trace.h"
+#if defined(__unix__) || defined(__APPLE__)
+#include "mapped_vector.h"
+#include "shm_vector.h"
+#include <cstdio>
+#include <filesystem>
+#endif
+#include <atomic>
+#include <cstring>
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 template <typename value> constexpr void rotate(value *first, value *mid, value *last) {
@@ -23,6 +45,11 @@ template <typename value> constexpr void rotate(value *first, value *mid, value
     }
 }
 
+// the Tag of the instrumentation and trace tests
+struct scratch_site {
+    static constexpr const char *name = "scratch";
+};
+
 int main() {
     int values[10];
     for (size_t i = 0; i < 10; i++)
@@ -67,10 +94,43 @@ int main() {
         return values;
     }();
 
+    constexpr containers::circular_plain_array<int, 32> test_circular = []() {
+        containers::circular_plain_array<int, 32> values;
+        for (size_t i = 0; i < values.capacity() / 2; i++)
+            values.unchecked_emplace_back(i);
+        for (; values.size() < (values.capacity() * 3 / 4);)
+            values.append(1, values.size());
+        for (; values.size() < values.capacity();)
+            values.emplace_back(values.size());
+        values.erase(values.begin() + 8, values.begin() + 24);
+        values.pop_front();
+        values.pop_front();
+        values.erase(values.begin() + 3);
+        values.pop_back();
+        values.pop_back();
+        values.insert(values.begin() + 6, 2, 4);
+        return values;
+    }();
+
     std::cout << "match test\n";
     for (size_t i = 0; i < test_safe.size(); i++) {
-        std::cout << test[i] << '\t' << test_safe[i] << '\n';
+        std::cout << test[i] << '\t' << test_safe[i] << '\t' << test_circular[i] << '\n';
+    }
+
+    containers::circular_plain_array<int, 8> window;
+    for (int i = 0; i < 20; i++) {
+        if (window.full())
+            window.pop_front();
+        window.push_back(i);
     }
+    std::cout << "circular test\n";
+    for (int value : window)
+        std::cout << value << ' ';
+    std::cout << "(linearized " << window.is_linearized() << ")\n";
+    int *contiguous = window.linearize();
+    for (size_t i = 0; i < window.size(); i++)
+        std::cout << contiguous[i] << ' ';
+    std::cout << "(linearized " << window.is_linearized() << ")\n";
 
     containers::plain_array<int, 32> swap_test;
     swap_test.emplace_back(10);
@@ -87,6 +147,270 @@ int main() {
     for (size_t i = 0; i < swap_test_2.size(); i++)
         std::cout << swap_test_2[i] << '\n';
 
+    std::cout << "packed_bits test\n";
+    {
+        containers::packed_bits<4096> visited(4096);
+        for (size_t i = 0; i < visited.size(); i += 97)
+            visited.set(i);
+        visited.set_range(1000, 1010);
+        size_t found = 0;
+        for (size_t i = visited.find_first(); i < visited.size(); i = visited.find_next(i))
+            found++;
+        std::cout << visited.count() << '\t' << found << '\t' << sizeof(visited) << '\n';
+    }
+
+    std::cout << "bit_vector test\n";
+    {
+        // a growing filter mask, odd rows and a resized tail of set bits, intersected with every third row
+        real::bit_vector<> mask;
+        for (size_t i = 0; i < 1000; i++)
+            mask.push_back(i % 2 == 1);
+        mask.resize(1100, true);
+        real::bit_vector<> thirds(mask.size());
+        for (size_t i = 0; i < thirds.size(); i += 3)
+            thirds.set(i);
+        mask &= thirds;
+        size_t found = 0;
+        for (size_t i = mask.find_first(); i < mask.size(); i = mask.find_next(i))
+            found++;
+        std::cout << mask.size() << '\t' << mask.count() << '\t' << found << '\t' << mask.word_count() << '\n';
+    }
+
+    std::cout << "ring_buffer test\n";
+    {
+        containers::ring_buffer<int, 64> handoff;
+        size_t                           sum = 0;
+        std::thread                      consumer([&]() {
+            int    batch[16];
+            size_t received = 0;
+            while (received < 1000) {
+                size_t popped = handoff.try_pop_n(batch, 16);
+                for (size_t i = 0; i < popped; i++)
+                    sum += batch[i];
+                received += popped;
+            }
+        });
+        int produced = 0;
+        while (produced < 1000) {
+            int batch[8];
+            for (int i = 0; i < 8; i++)
+                batch[i] = produced + i;
+            produced += handoff.try_push_n(batch, (1000 - produced) < 8 ? (1000 - produced) : 8);
+        }
+        consumer.join();
+        std::cout << sum << '\t' << (999 * 1000 / 2) << '\n';
+    }
+
+    std::cout << "mpmc_ring_buffer test\n";
+    {
+        // 2 producers push 0 .. 1999 between them, 2 consumers pop them in batches
+        containers::mpmc_ring_buffer<int, 64> queue;
+        std::atomic<size_t>                   received{0};
+        std::atomic<size_t>                   sum{0};
+        std::vector<std::thread>              threads;
+        for (int p = 0; p < 2; p++) {
+            threads.emplace_back([&, p]() {
+                int produced = 0;
+                while (produced < 1000) {
+                    int batch[8];
+                    for (int i = 0; i < 8; i++)
+                        batch[i] = p * 1000 + produced + i;
+                    const size_t pushed = queue.try_push_n(batch, (1000 - produced) < 8 ? (1000 - produced) : 8);
+                    if (!pushed)
+                        std::this_thread::yield();
+                    produced += static_cast<int>(pushed);
+                }
+            });
+        }
+        for (int c = 0; c < 2; c++) {
+            threads.emplace_back([&]() {
+                int batch[16];
+                while (received.load() < 2000) {
+                    const size_t popped = queue.try_pop_n(batch, 16);
+                    if (!popped)
+                        std::this_thread::yield();
+                    for (size_t i = 0; i < popped; i++)
+                        sum += batch[i];
+                    received += popped;
+                }
+            });
+        }
+        for (std::thread &thread : threads)
+            thread.join();
+        std::cout << sum << '\t' << (1999 * 2000 / 2) << '\t' << queue.empty() << '\n';
+    }
+
+    std::cout << "instrumentation test\n";
+    {
+        real::vector<int, std::allocator<int>, real::counting_instrumentation<scratch_site>> scratch;
+        for (int i = 0; i < 100; i++)
+            scratch.push_back(i);
+        scratch.insert(scratch.begin() + 50, 3, -1);
+        scratch.erase(scratch.begin(), scratch.begin() + 10);
+        scratch.shrink_to_fit();
+        real::write_instrumentation_json(std::cout);
+    }
+
+    std::cout << "trace test\n";
+    {
+        real::vector<int, std::allocator<int>, real::trace_instrumentation<scratch_site>> scratch;
+        scratch.reserve(16);
+        for (int i = 0; i < 20; i++)
+            scratch.push_back(i);
+        scratch.insert(scratch.begin() + 5, 2, -1);
+        scratch.erase(scratch.begin() + 1);
+        scratch.pop_back();
+        scratch.clear();
+        real::write_trace(std::cout, real::trace_instrumentation<scratch_site>::trace());
+    }
+
+#if defined(__unix__) || defined(__APPLE__)
+    std::cout << "mapped vector test\n";
+    {
+        const std::string path = (std::filesystem::temp_directory_path() / "containers_mapped_vector.bin").string();
+        std::remove(path.c_str());
+        {
+            real::mapped_vector<uint64_t> table(path.c_str());
+            for (uint64_t i = 0; i < 100000; i++)
+                table.push_back(i * i);
+            table.flush();
+        }
+        // re-opening maps the values back, nothing is parsed
+        real::mapped_view<uint64_t> table(path.c_str());
+        // the read only mapping has nothing that writes it
+        const auto clearable = [](auto &view) { return std::bool_constant<requires { view.clear(); }>{}; };
+        static_assert(!decltype(clearable(table))::value);
+        static_assert(std::is_same_v<decltype(table[0]), const uint64_t &>);
+        std::cout << table.size() << " values, table[99999] = " << table[99999] << '\n';
+        std::remove(path.c_str());
+    }
+
+    std::cout << "shared memory vector test\n";
+    {
+        const char *name = "/containers_shm_vector";
+        real::shm_segment::remove(name);
+        real::shm_segment writer(name, real::shm_mode::create, 1 << 22);
+        auto &values = writer.find_or_construct<real::shm_vector<uint64_t>>("values", writer.allocator<uint64_t>());
+        values.reserve(100000);
+        for (uint64_t i = 0; i < 100000; i++)
+            values.push_back(i * 7);
+        // a second mapping lands at another address, the offset pointers follow it
+        real::shm_segment reader(name, real::shm_mode::open);
+        const auto *shared = reader.find<real::shm_vector<uint64_t>>("values");
+        std::cout << shared->size() << " values, values[99999] = " << (*shared)[99999] << '\n';
+        writer.destroy<real::shm_vector<uint64_t>>("values");
+        real::shm_segment::remove(name);
+    }
+
+#endif
+    std::cout << "serialization test\n";
+    {
+        stable_stack<uint64_t, 32> blocks;
+        for (uint64_t i = 0; i < 100; i++)
+            blocks.emplace_back(i * 3);
+        containers::serialized_buffers gathered;
+        containers::gather(blocks, gathered);
+        std::cout << gathered.buffers.size() << " buffers, " << gathered.size_bytes() << " bytes\n";
+
+        std::ostringstream out;
+        containers::serialize(out, blocks);
+        // a received message, copied into storage aligned for the values
+        const std::string     message = out.str();
+        std::vector<uint64_t> storage((message.size() + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+        std::memcpy(storage.data(), message.data(), message.size());
+        std::span<const uint64_t> values =
+            containers::view_from<uint64_t>(std::as_bytes(std::span<const uint64_t>(storage)));
+        std::cout << values.size() << " values, values[99] = " << values[99] << '\n';
+    }
+
+    std::cout << "arena test\n";
+    {
+        containers::counting_resource  upstream;
+        containers::inline_arena<4096> scratch(&upstream);
+        for (int request = 0; request < 3; request++) {
+            containers::arena_vector<int> ids{containers::arena_allocator<int>(scratch)};
+            pmr::real::vector<double>     weights{&scratch};
+            for (int i = 0; i < 100; i++) {
+                ids.push_back(i);
+                weights.push_back(i * 0.5);
+            }
+            std::cout << ids.size() + weights.size() << " values, " << scratch.upstream_chunks() << " chunks, "
+                      << upstream.stats().allocations << " upstream allocations\n";
+            scratch.release();
+        }
+        containers::arena_vector<int> big{containers::arena_allocator<int>(scratch)};
+        for (int i = 0; i < 100000; i++)
+            big.push_back(i);
+        std::cout << big.size() << " values, " << scratch.upstream_chunks() << " chunks, "
+                  << upstream.stats().allocations << " upstream allocations\n";
+    }
+
+    std::cout << "thin vector test\n";
+    {
+        // adjacency lists, most nodes have no edges
+        std::vector<real::thin_vector<uint32_t>> edges(100000);
+        for (uint32_t node = 0; node < edges.size(); node += 97)
+            for (uint32_t e = 0; e < 5; e++)
+                edges[node].push_back((node + e * 31) % edges.size());
+        size_t total = 0;
+        for (const real::thin_vector<uint32_t> &list : edges)
+            total += list.size();
+        std::cout << sizeof(real::thin_vector<uint32_t>) << " bytes per list (real::vector "
+                  << sizeof(real::vector<uint32_t>) << "), " << total << " edges\n";
+    }
+
+    std::cout << "packed int vector test\n";
+    {
+        // a sorted id column, ids fit in 20 bits
+        real::packed_int_vector<20> packed;
+        real::delta_int_vector<>    deltas;
+        uint64_t                    id = 1000;
+        for (int i = 0; i < 100000; i++) {
+            id += 1 + (i % 5);
+            packed.push_back(id);
+            deltas.push_back(id);
+        }
+        std::vector<uint64_t> decoded(packed.size());
+        deltas.decode(0, deltas.size(), decoded.data());
+        std::cout << packed.size() << " ids, " << packed.bytes() << " bytes packed, " << deltas.bytes()
+                  << " bytes delta coded, ids[99999] = " << packed[99999] << " / " << decoded[99999] << '\n';
+    }
+
+    std::cout << "ragged vector test\n";
+    {
+        // a small graph from an unordered edge list, neighbours of each node are one row
+        std::vector<std::pair<uint32_t, uint32_t>> edges;
+        for (uint32_t i = 0; i < 4096; i++)
+            edges.emplace_back((i * 2654435761u) % 256, i / 16);
+        real::ragged_vector<uint32_t> graph = real::ragged_vector<uint32_t>::from_pairs(256, edges);
+        std::vector<uint64_t>         sums(graph.rows());
+        graph.parallel_for_each_row(
+            [&](size_t node, std::span<const uint32_t> next) {
+                for (uint32_t n : next)
+                    sums[node] += n;
+            },
+            4);
+        std::cout << graph.rows() << " rows, " << graph.size() << " values, row 0 has " << graph[0].size()
+                  << " values summing to " << sums[0] << '\n';
+    }
+
+    std::cout << "simd vector test\n";
+    {
+        // 64 byte aligned, capacity in whole 16 float registers, the lanes past size() read as zero
+        real::simd_vector<float> xs;
+        for (int i = 0; i < 37; i++)
+            xs.push_back(float(i));
+        float sums[16] = {};
+        for (size_t i = 0; i < xs.size(); i += 16)
+            for (size_t lane = 0; lane < 16; lane++)
+                sums[lane] += xs.data()[i + lane];
+        float sum = 0;
+        for (float lane_sum : sums)
+            sum += lane_sum;
+        std::cout << xs.size() << " values, capacity " << xs.capacity() << ", data() % 64 = "
+                  << reinterpret_cast<uintptr_t>(xs.data()) % 64 << ", sum " << sum << '\n';
+    }
+
     std::cout << "constexpr test\n";
 
     for (size_t i = 0; i < test.size(); i++)
@@ -129,6 +453,33 @@ int main() {
         }
     });
 
+    // top-k style small sorts, the network path vs introsort
+    ankerl::nanobench::Bench sort_benchmark;
+    sort_benchmark.epochs(1024);
+    sort_benchmark.minEpochIterations(128);
+    sort_benchmark.warmup(4);
+    sort_benchmark.unit("sort");
+    sort_benchmark.performanceCounters(true);
+    sort_benchmark.relative(true);
+
+    ankerl::nanobench::Rng           rng;
+    containers::plain_array<int, 16> sort_source;
+    for (size_t i = 0; i < sort_source.capacity(); i++)
+        sort_source.emplace_back(static_cast<int>(rng.bounded(1000)));
+    containers::plain_array<int, 16> sort_test;
+
+    sort_benchmark.run("plain_array<int, 16> (std::sort)", [&]() {
+        sort_test = sort_source;
+        std::sort(sort_test.begin(), sort_test.end());
+        ankerl::nanobench::doNotOptimizeAway(sort_test);
+    });
+
+    sort_benchmark.run("plain_array<int, 16> (sort network)", [&]() {
+        sort_test = sort_source;
+        sort_test.sort();
+        ankerl::nanobench::doNotOptimizeAway(sort_test);
+    });
+
     /*
     // 1 2 3 4 5 6 7 8
     // 3 4 5 6 7 8 1 2
@@ -0,0 +1,190 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2020 Alex Anderson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// allocation_stats: allocation counters shared by every copy / rebind of a counting_allocator
+//  or owned by a counting_resource, plain integers so one stats object belongs to one thread
+//  reallocations counts allocations made while another block is still live, for a single
+//  container that is every growth which had to move the values
+// counting_allocator<T, Allocator>: forwards to Allocator, records into allocation_stats
+//  (default constructed allocators record into the calling thread's default_allocation_stats())
+// counting_resource: the std::pmr::memory_resource equivalent, forwards to an upstream resource
+
+namespace containers {
+    struct allocation_stats {
+        using size_type = ::std::size_t;
+
+        size_type allocations       = 0;
+        size_type deallocations     = 0;
+        size_type reallocations     = 0;
+        size_type bytes_allocated   = 0;
+        size_type bytes_deallocated = 0;
+        size_type live_blocks       = 0;
+        size_type live_bytes        = 0;
+        size_type peak_bytes        = 0;
+
+        constexpr void record_allocate(size_type bytes) noexcept {
+            allocations++;
+            reallocations += live_blocks != 0;
+            bytes_allocated += bytes;
+            live_blocks++;
+            live_bytes += bytes;
+            peak_bytes = live_bytes > peak_bytes ? live_bytes : peak_bytes;
+        }
+
+        constexpr void record_deallocate(size_type bytes) noexcept {
+            deallocations++;
+            bytes_deallocated += bytes;
+            live_blocks--;
+            live_bytes -= bytes;
+        }
+
+        // clears the counters, peak_bytes restarts from what is still live
+        constexpr void reset() noexcept {
+            allocations       = 0;
+            deallocations     = 0;
+            reallocations     = 0;
+            bytes_allocated   = 0;
+            bytes_deallocated = 0;
+            peak_bytes        = live_bytes;
+        }
+    };
+
+    inline allocation_stats &default_allocation_stats() noexcept {
+        thread_local allocation_stats stats;
+        return stats;
+    }
+
+    template <typename T, typename Allocator = ::std::allocator<T>> struct counting_allocator : private Allocator {
+        template <typename, typename> friend struct counting_allocator;
+
+      private:
+        using allocator_traits = ::std::allocator_traits<Allocator>;
+
+        allocation_stats *_stats;
+
+      public:
+        using value_type      = T;
+        using size_type       = typename allocator_traits::size_type;
+        using difference_type = typename allocator_traits::difference_type;
+        using upstream_type   = Allocator;
+
+        using propagate_on_container_copy_assignment = ::std::true_type;
+        using propagate_on_container_move_assignment = ::std::true_type;
+        using propagate_on_container_swap            = ::std::true_type;
+        using is_always_equal                        = ::std::false_type;
+
+        template <typename U> struct rebind {
+            using other = counting_allocator<U, typename allocator_traits::template rebind_alloc<U>>;
+        };
+
+        counting_allocator() noexcept(::std::is_nothrow_default_constructible_v<Allocator>)
+            : Allocator(), _stats(&default_allocation_stats()) {
+        }
+        explicit counting_allocator(allocation_stats &stats,
+                                    const Allocator &upstream = Allocator()) noexcept
+            : Allocator(upstream), _stats(&stats) {
+        }
+        template <typename U, typename OtherAllocator>
+        counting_allocator(const counting_allocator<U, OtherAllocator> &other) noexcept
+            : Allocator(other.upstream()), _stats(other._stats) {
+        }
+
+        [[nodiscard]] T *allocate(size_type count) {
+            T *ptr = allocator_traits::allocate(upstream(), count);
+            _stats->record_allocate(count * sizeof(T));
+            return ptr;
+        }
+
+        void deallocate(T *ptr, size_type count) noexcept {
+            _stats->record_deallocate(count * sizeof(T));
+            allocator_traits::deallocate(upstream(), ptr, count);
+        }
+
+        [[nodiscard]] allocation_stats &stats() const noexcept {
+            return *_stats;
+        }
+
+        [[nodiscard]] Allocator &upstream() noexcept {
+            return *this;
+        }
+        [[nodiscard]] const Allocator &upstream() const noexcept {
+            return *this;
+        }
+
+        template <typename U, typename OtherAllocator>
+        friend bool operator==(const counting_allocator &left, const counting_allocator<U, OtherAllocator> &right) noexcept {
+            return left._stats == right._stats && left.upstream() == right.upstream();
+        }
+        template <typename U, typename OtherAllocator>
+        friend bool operator!=(const counting_allocator &left, const counting_allocator<U, OtherAllocator> &right) noexcept {
+            return !(left == right);
+        }
+    };
+
+    struct counting_resource : ::std::pmr::memory_resource {
+      private:
+        ::std::pmr::memory_resource *_upstream;
+        allocation_stats             _stats;
+
+      public:
+        explicit counting_resource(::std::pmr::memory_resource *upstream = ::std::pmr::get_default_resource()) noexcept
+            : _upstream(upstream) {
+        }
+
+        counting_resource(const counting_resource &)            = delete;
+        counting_resource &operator=(const counting_resource &) = delete;
+
+        [[nodiscard]] allocation_stats &stats() noexcept {
+            return _stats;
+        }
+        [[nodiscard]] const allocation_stats &stats() const noexcept {
+            return _stats;
+        }
+        [[nodiscard]] ::std::pmr::memory_resource *upstream_resource() const noexcept {
+            return _upstream;
+        }
+
+      protected:
+        void *do_allocate(::std::size_t bytes, ::std::size_t alignment) override {
+            void *ptr = _upstream->allocate(bytes, alignment);
+            _stats.record_allocate(bytes);
+            return ptr;
+        }
+
+        void do_deallocate(void *ptr, ::std::size_t bytes, ::std::size_t alignment) override {
+            _stats.record_deallocate(bytes);
+            _upstream->deallocate(ptr, bytes, alignment);
+        }
+
+        bool do_is_equal(const ::std::pmr::memory_resource &other) const noexcept override {
+            return this == &other;
+        }
+    };
+} // namespace containers
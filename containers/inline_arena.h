@@ -0,0 +1,190 @@
+#pragma once
+#include "real_vector.h"
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2021 Alex Anderson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// arena_resource: a std::pmr::memory_resource bumping through a caller's buffer, then through chunks taken from
+//  an upstream resource, each twice the size of the last, deallocate does nothing
+//  release() hands the chunks back (one upstream call per chunk, not per allocation) and rewinds to the buffer
+// inline_arena<Bytes>: an arena_resource whose first chunk is Bytes of (uninitialized) storage inside the object,
+//  so a scratch arena on the stack serves small requests without touching malloc
+// arena_allocator<T>: an allocator for an arena_resource that declares releases_in_bulk, a real::vector of
+//  trivially destructible values using it skips destruction and deallocation on teardown
+//
+//	containers::inline_arena<16384> scratch;
+//	containers::arena_vector<int>   ids{containers::arena_allocator<int>(scratch)};
+//	pmr::real::vector<float>        weights{&scratch};
+//	...
+//	scratch.release(); // everything at once, ids and weights must be gone or unused
+
+namespace containers {
+    class arena_resource : public ::std::pmr::memory_resource {
+        struct chunk_header {
+            chunk_header *previous;
+            ::std::size_t bytes;
+        };
+
+        ::std::byte                 *_initial;
+        ::std::size_t                _initial_bytes;
+        ::std::byte                 *_cursor;
+        ::std::byte                 *_limit;
+        chunk_header                *_chunks     = nullptr;
+        ::std::size_t                _chunk_count = 0;
+        ::std::size_t                _next_chunk_bytes;
+        ::std::pmr::memory_resource *_upstream;
+
+        void _grow(::std::size_t bytes, ::std::size_t alignment) {
+            const ::std::size_t limit = ::std::numeric_limits<::std::size_t>::max() / 2;
+            if (bytes > limit - alignment - sizeof(chunk_header))
+                throw ::std::bad_alloc();
+            const ::std::size_t needed      = sizeof(chunk_header) + alignment + bytes;
+            const ::std::size_t chunk_bytes = needed > _next_chunk_bytes ? needed : _next_chunk_bytes;
+            void *memory = _upstream->allocate(chunk_bytes, alignof(::std::max_align_t));
+            _chunks      = ::new (memory) chunk_header{_chunks, chunk_bytes};
+            _chunk_count++;
+            _cursor           = reinterpret_cast<::std::byte *>(_chunks + 1);
+            _limit            = static_cast<::std::byte *>(memory) + chunk_bytes;
+            _next_chunk_bytes = chunk_bytes < limit ? chunk_bytes * 2 : chunk_bytes;
+        }
+
+      public:
+        arena_resource(void *buffer, ::std::size_t bytes,
+                       ::std::pmr::memory_resource *upstream = ::std::pmr::get_default_resource()) noexcept
+            : _initial(static_cast<::std::byte *>(buffer)), _initial_bytes(bytes), _cursor(_initial),
+              _limit(_initial + bytes), _next_chunk_bytes(bytes * 2 > 1024 ? bytes * 2 : 1024), _upstream(upstream) {
+        }
+
+        arena_resource(const arena_resource &)            = delete;
+        arena_resource &operator=(const arena_resource &) = delete;
+
+        ~arena_resource() override {
+            release();
+        }
+
+        // frees every chunk and rewinds to the initial buffer, everything allocated from the arena is gone
+        void release() noexcept {
+            while (_chunks) {
+                chunk_header *previous = _chunks->previous;
+                _upstream->deallocate(_chunks, _chunks->bytes, alignof(::std::max_align_t));
+                _chunks = previous;
+            }
+            _chunk_count      = 0;
+            _next_chunk_bytes = _initial_bytes * 2 > 1024 ? _initial_bytes * 2 : 1024;
+            _cursor           = _initial;
+            _limit            = _initial + _initial_bytes;
+        }
+
+        // chunks taken from upstream since the last release()
+        [[nodiscard]] ::std::size_t upstream_chunks() const noexcept {
+            return _chunk_count;
+        }
+        // bytes left before the next chunk
+        [[nodiscard]] ::std::size_t remaining() const noexcept {
+            return static_cast<::std::size_t>(_limit - _cursor);
+        }
+        [[nodiscard]] ::std::pmr::memory_resource *upstream_resource() const noexcept {
+            return _upstream;
+        }
+
+      protected:
+        void *do_allocate(::std::size_t bytes, ::std::size_t alignment) override {
+            void         *ptr   = _cursor;
+            ::std::size_t space = remaining();
+            if (!::std::align(alignment, bytes, ptr, space)) {
+                _grow(bytes, alignment);
+                ptr   = _cursor;
+                space = remaining();
+                ::std::align(alignment, bytes, ptr, space);
+            }
+            _cursor = static_cast<::std::byte *>(ptr) + bytes;
+            return ptr;
+        }
+
+        void do_deallocate(void *, ::std::size_t, ::std::size_t) override {
+        }
+
+        bool do_is_equal(const ::std::pmr::memory_resource &other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    template <::std::size_t Bytes> class inline_arena : public arena_resource {
+        alignas(::std::max_align_t) ::std::byte _storage[Bytes];
+
+      public:
+        explicit inline_arena(::std::pmr::memory_resource *upstream = ::std::pmr::get_default_resource()) noexcept
+            : arena_resource(_storage, Bytes, upstream) {
+        }
+    };
+
+    template <typename T> struct arena_allocator {
+        template <typename> friend struct arena_allocator;
+
+      private:
+        arena_resource *_arena;
+
+      public:
+        using value_type      = T;
+        using size_type       = ::std::size_t;
+        using difference_type = ::std::ptrdiff_t;
+
+        // the arena frees everything in release(), real::vector skips deallocating trivially destructible values
+        static constexpr bool releases_in_bulk = true;
+
+        explicit arena_allocator(arena_resource &arena) noexcept : _arena(&arena) {
+        }
+        template <typename U> arena_allocator(const arena_allocator<U> &other) noexcept : _arena(other._arena) {
+        }
+
+        [[nodiscard]] T *allocate(size_type count) {
+            if (count > ::std::numeric_limits<size_type>::max() / sizeof(T))
+                throw ::std::bad_array_new_length();
+            return static_cast<T *>(_arena->allocate(count * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T *ptr, size_type count) noexcept {
+            _arena->deallocate(ptr, count * sizeof(T), alignof(T));
+        }
+
+        [[nodiscard]] arena_resource &arena() const noexcept {
+            return *_arena;
+        }
+
+        template <typename U> friend bool operator==(const arena_allocator &left, const arena_allocator<U> &right) noexcept {
+            return left._arena == right._arena;
+        }
+        template <typename U> friend bool operator!=(const arena_allocator &left, const arena_allocator<U> &right) noexcept {
+            return !(left == right);
+        }
+    };
+
+    template <typename T> using arena_vector = ::real::vector<T, arena_allocator<T>>;
+} // namespace containers
@@ -0,0 +1,404 @@
+#pragma once
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2021 Alex Anderson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// mapped_vector<T>: a vector of trivially copyable values living in a file mapped with mmap (POSIX)
+//  the file is a small header (magic, element size and alignment, size) followed by the values, the size is
+//  kept in the mapping so re-opening is a header check and an mmap, no parsing, however large the file
+//  growth extends the file with ftruncate and the mapping with mremap (munmap + mmap where there is no mremap),
+//  the capacity is the file size, shrink_to_fit trims the file
+//  flush() msyncs the mapping to the file, otherwise the kernel writes dirty pages back on its own schedule
+//  (and at close)
+// mapped_view<T>: the same file mapped read only (PROT_READ), only const access, no member writes the mapping,
+//  shares the page cache with every other process mapping the file
+//  pointers and iterators are invalidated by growth like any vector, the file must not be resized by others
+//  errors from the OS throw std::system_error, a file of another type throws std::runtime_error
+//
+//	real::mapped_vector<uint64_t> table("lookup.bin"); // created empty, or re-opened with its values
+//	if (table.empty())
+//		build(table);
+//	table.flush();
+//	real::mapped_view<uint64_t> shared("lookup.bin"); // in another process
+
+namespace real {
+	template <typename T> class mapped_view;
+
+	namespace details {
+		enum class map_mode { read_write, read_only };
+
+		struct mapped_header {
+			char     magic[8];
+			uint64_t element_size;
+			uint64_t element_alignment;
+			uint64_t size;
+		};
+
+		inline constexpr char mapped_magic[8] = {'r', 'e', 'a', 'l', 'm', 'a', 'p', '1'};
+
+		[[noreturn]] inline void throw_errno(const char *what) {
+			throw ::std::system_error(errno, ::std::generic_category(), what);
+		}
+	} // namespace details
+
+	template <typename T> class mapped_vector {
+		static_assert(::std::is_trivially_copyable<T>::value, "mapped_vector stores values as raw bytes");
+
+	  public:
+		using element_type           = T;
+		using value_type             = typename ::std::remove_cv<T>::type;
+		using const_reference        = const value_type &;
+		using size_type              = ::std::size_t;
+		using difference_type        = ::std::ptrdiff_t;
+		using pointer                = element_type *;
+		using const_pointer          = const element_type *;
+		using reference              = element_type &;
+		using iterator               = pointer;
+		using const_iterator         = const_pointer;
+		using reverse_iterator       = ::std::reverse_iterator<iterator>;
+		using const_reverse_iterator = ::std::reverse_iterator<const_iterator>;
+
+		// values start at the first multiple of their alignment after the header
+		static constexpr size_type data_offset =
+			(sizeof(details::mapped_header) + alignof(T) - 1) / alignof(T) * alignof(T);
+
+	  private:
+		int       _fd    = -1;
+		void     *_map   = nullptr;
+		size_type _bytes = 0; // mapped bytes, equal to the file size
+		details::map_mode _mode = details::map_mode::read_write;
+
+		[[nodiscard]] details::mapped_header *_header() const noexcept {
+			return static_cast<details::mapped_header *>(_map);
+		}
+
+		// null once moved from
+		[[nodiscard]] T *_data() const noexcept {
+			return _map ? reinterpret_cast<T *>(static_cast<char *>(_map) + data_offset) : nullptr;
+		}
+
+		void _map_file(size_type bytes) {
+			const int protection = _mode == details::map_mode::read_only ? PROT_READ : PROT_READ | PROT_WRITE;
+			void     *map        = ::mmap(nullptr, bytes, protection, MAP_SHARED, _fd, 0);
+			if (map == MAP_FAILED)
+				details::throw_errno("mmap");
+			_map   = map;
+			_bytes = bytes;
+		}
+
+		// the file grows before the mapping and shrinks after it, so the mapping never outruns the file
+		void _resize_file(size_type bytes) {
+			assert(_mode == details::map_mode::read_write && "mapped_view writing its mapping");
+			const size_type old_bytes = _bytes;
+			if (bytes > old_bytes && ::ftruncate(_fd, static_cast<off_t>(bytes)) != 0)
+				details::throw_errno("ftruncate");
+#ifdef MREMAP_MAYMOVE
+			void *map = ::mremap(_map, old_bytes, bytes, MREMAP_MAYMOVE);
+			if (map == MAP_FAILED)
+				details::throw_errno("mremap");
+			_map   = map;
+			_bytes = bytes;
+#else
+			::munmap(_map, old_bytes);
+			_map = nullptr;
+			_map_file(bytes);
+#endif
+			if (bytes < old_bytes && ::ftruncate(_fd, static_cast<off_t>(bytes)) != 0)
+				details::throw_errno("ftruncate");
+		}
+
+		void _close() noexcept {
+			if (_map)
+				::munmap(_map, _bytes);
+			if (_fd != -1)
+				::close(_fd);
+			_map   = nullptr;
+			_fd    = -1;
+			_bytes = 0;
+		}
+
+		friend class mapped_view<T>;
+
+		// read_only is only reachable through mapped_view, which exposes none of the members that write
+		mapped_vector(const char *path, details::map_mode mode) : _mode(mode) {
+			const int flags = mode == details::map_mode::read_only ? O_RDONLY : O_RDWR | O_CREAT;
+			_fd             = ::open(path, flags | O_CLOEXEC, 0644);
+			if (_fd == -1)
+				details::throw_errno(path);
+
+			struct stat info = {};
+			if (::fstat(_fd, &info) != 0) {
+				const int error = errno;
+				_close();
+				throw ::std::system_error(error, ::std::generic_category(), "fstat");
+			}
+			size_type bytes = static_cast<size_type>(info.st_size);
+			try {
+				if (bytes == 0 && mode == details::map_mode::read_write) {
+					bytes = data_offset;
+					if (::ftruncate(_fd, static_cast<off_t>(bytes)) != 0)
+						details::throw_errno("ftruncate");
+					_map_file(bytes);
+					details::mapped_header *header = _header();
+					::std::memcpy(header->magic, details::mapped_magic, sizeof(header->magic));
+					header->element_size      = sizeof(T);
+					header->element_alignment = alignof(T);
+					header->size              = 0;
+				} else {
+					if (bytes < data_offset)
+						throw ::std::runtime_error("mapped_vector: file too small for its header");
+					_map_file(bytes);
+					const details::mapped_header *header = _header();
+					if (::std::memcmp(header->magic, details::mapped_magic, sizeof(header->magic)) != 0 ||
+					    header->element_size != sizeof(T) || header->element_alignment != alignof(T))
+						throw ::std::runtime_error("mapped_vector: file holds another type");
+					if (header->size > (bytes - data_offset) / sizeof(T))
+						throw ::std::runtime_error("mapped_vector: file is truncated");
+				}
+			} catch (...) {
+				_close();
+				throw;
+			}
+		}
+
+	  public:
+		// opens path, creating an empty vector when the file does not exist (or is empty)
+		explicit mapped_vector(const char *path) : mapped_vector(path, details::map_mode::read_write) {
+		}
+
+		mapped_vector(const mapped_vector &)            = delete;
+		mapped_vector &operator=(const mapped_vector &) = delete;
+
+		mapped_vector(mapped_vector &&other) noexcept
+			: _fd(::std::exchange(other._fd, -1)), _map(::std::exchange(other._map, nullptr)),
+			  _bytes(::std::exchange(other._bytes, 0)), _mode(other._mode) {
+		}
+
+		mapped_vector &operator=(mapped_vector &&other) noexcept {
+			if (this != &other) {
+				_close();
+				_fd    = ::std::exchange(other._fd, -1);
+				_map   = ::std::exchange(other._map, nullptr);
+				_bytes = ::std::exchange(other._bytes, 0);
+				_mode  = other._mode;
+			}
+			return *this;
+		}
+
+		// unmaps without msync, dirty pages still reach the file through the page cache
+		~mapped_vector() {
+			_close();
+		}
+
+		// size / capacity
+		[[nodiscard]] size_type size() const noexcept {
+			return _map ? static_cast<size_type>(_header()->size) : 0;
+		}
+		[[nodiscard]] size_type capacity() const noexcept {
+			return _map ? (_bytes - data_offset) / sizeof(T) : 0;
+		}
+		[[nodiscard]] bool empty() const noexcept {
+			return size() == 0;
+		}
+
+		// data / iterators
+		[[nodiscard]] pointer data() noexcept {
+			return _data();
+		}
+		[[nodiscard]] const_pointer data() const noexcept {
+			return _data();
+		}
+		[[nodiscard]] iterator begin() noexcept {
+			return _data();
+		}
+		[[nodiscard]] const_iterator begin() const noexcept {
+			return _data();
+		}
+		[[nodiscard]] iterator end() noexcept {
+			return _data() + size();
+		}
+		[[nodiscard]] const_iterator end() const noexcept {
+			return _data() + size();
+		}
+		[[nodiscard]] reverse_iterator rbegin() noexcept {
+			return reverse_iterator(end());
+		}
+		[[nodiscard]] reverse_iterator rend() noexcept {
+			return reverse_iterator(begin());
+		}
+
+		//[]'s
+		[[nodiscard]] reference operator[](size_type pos) noexcept {
+			assert(pos < size());
+			return _data()[pos];
+		}
+		[[nodiscard]] const_reference operator[](size_type pos) const noexcept {
+			assert(pos < size());
+			return _data()[pos];
+		}
+		[[nodiscard]] reference back() noexcept {
+			return _data()[size() - 1];
+		}
+		[[nodiscard]] reference front() noexcept {
+			return _data()[0];
+		}
+
+		// grows the file to hold new_capacity values
+		void reserve(size_type new_capacity) {
+			if (new_capacity > capacity()) {
+				if (new_capacity > (static_cast<size_type>(-1) - data_offset) / sizeof(T))
+					throw ::std::length_error("cannot allocate larger than max_size");
+				_resize_file(data_offset + new_capacity * sizeof(T));
+			}
+		}
+
+		// trims the file to size()
+		void shrink_to_fit() {
+			if (capacity() != size())
+				_resize_file(data_offset + size() * sizeof(T));
+		}
+
+		template <class... Args> reference emplace_back(Args &&...args) {
+			const size_type old_size = size();
+			if (old_size == capacity()) {
+				// args may refer into this vector, which _resize_file's mremap can move
+				T value(::std::forward<Args>(args)...);
+				// the first growth fills the rest of the header's page
+				const size_type page_values = data_offset < 4096 ? (4096 - data_offset) / sizeof(T) : 0;
+				reserve(old_size ? old_size * 2 : (page_values ? page_values : 1));
+				T *it = ::new ((void *)(_data() + old_size)) T(::std::move(value));
+				_header()->size = old_size + 1;
+				return *it;
+			}
+			T *it = ::new ((void *)(_data() + old_size)) T(::std::forward<Args>(args)...);
+			_header()->size = old_size + 1;
+			return *it;
+		}
+		void push_back(const T &value) {
+			emplace_back(value);
+		}
+
+		void pop_back() noexcept {
+			assert(size() && "pop_back on an empty mapped_vector");
+			_header()->size -= 1;
+		}
+
+		// new values are value initialized
+		void resize(size_type count) {
+			const size_type old_size = size();
+			if (count > old_size) {
+				reserve(count);
+				for (size_type i = old_size; i < count; i++)
+					::new ((void *)(_data() + i)) T();
+			}
+			_header()->size = count;
+		}
+
+		void clear() noexcept {
+			_header()->size = 0;
+		}
+
+		// writes dirty pages back to the file, blocking until they are written
+		void flush() {
+			if (::msync(_map, _bytes, MS_SYNC) != 0)
+				details::throw_errno("msync");
+		}
+		// schedules the write back and returns
+		void flush_async() {
+			if (::msync(_map, _bytes, MS_ASYNC) != 0)
+				details::throw_errno("msync");
+		}
+	};
+
+	template <typename T> class mapped_view {
+		mapped_vector<T> _vector;
+
+	  public:
+		using element_type           = const T;
+		using value_type             = typename mapped_vector<T>::value_type;
+		using size_type              = ::std::size_t;
+		using difference_type        = ::std::ptrdiff_t;
+		using pointer                = const T *;
+		using const_pointer          = const T *;
+		using reference              = const T &;
+		using const_reference        = const T &;
+		using iterator               = const_pointer;
+		using const_iterator         = const_pointer;
+		using reverse_iterator       = ::std::reverse_iterator<const_iterator>;
+		using const_reverse_iterator = ::std::reverse_iterator<const_iterator>;
+
+		// maps an existing mapped_vector file, throws std::system_error when there is none
+		explicit mapped_view(const char *path) : _vector(path, details::map_mode::read_only) {
+		}
+
+		[[nodiscard]] size_type size() const noexcept {
+			return _vector.size();
+		}
+		[[nodiscard]] bool empty() const noexcept {
+			return _vector.empty();
+		}
+
+		[[nodiscard]] const_pointer data() const noexcept {
+			return _vector.data();
+		}
+		[[nodiscard]] const_iterator begin() const noexcept {
+			return _vector.begin();
+		}
+		[[nodiscard]] const_iterator end() const noexcept {
+			return _vector.end();
+		}
+		[[nodiscard]] const_reverse_iterator rbegin() const noexcept {
+			return const_reverse_iterator(end());
+		}
+		[[nodiscard]] const_reverse_iterator rend() const noexcept {
+			return const_reverse_iterator(begin());
+		}
+
+		[[nodiscard]] const_reference operator[](size_type pos) const noexcept {
+			return ::std::as_const(_vector)[pos];
+		}
+		[[nodiscard]] const_reference front() const noexcept {
+			return *begin();
+		}
+		[[nodiscard]] const_reference back() const noexcept {
+			return *(end() - 1);
+		}
+	};
+} // namespace real
@@ -175,7 +175,8 @@ class BigO;
  *    Apart from these tags, it is also possible to use some mathematical operations on the measurement data. The operations
  *    are of the form `{{command(name)}}`.  Currently `name` can be one of `elapsed`, `iterations`. If performance counters
  *    are available (currently only on current Linux systems), you also have `pagefaults`, `cpucycles`,
- *    `contextswitches`, `instructions`, `branchinstructions`, and `branchmisses`. All the measuers (except `iterations`) are
+ *    `contextswitches`, `instructions`, `branchinstructions`, and `branchmisses`, with Bench::cacheCounters() also
+ *    `l1dmisses`, `llcmisses` and `dtlbmisses`. All the measuers (except `iterations`) are
  *    provided for a single iteration (so `elapsed` is the time a single iteration took). The following tags are available:
  *
  *    * `{{median(<name>)}}` Calculate median of a measurement data set, e.g. `{{median(elapsed)}}`.
@@ -230,6 +231,9 @@ class BigO;
  *
  *       * `{{branchmisses}}` Average number of branches that were missed per iteration.
  *
+ *       * `{{l1dmisses}}`, `{{llcmisses}}`, `{{dtlbmisses}}` Average number of L1 data cache, last level cache and data TLB
+ *         read misses per iteration.
+ *
  *    * `{{/measurement}}` Ends the measurement tag.
  *
  * * `{{/result}}` Marks the end of the result layer. This is the end marker for the template part that will be instantiated
@@ -366,6 +370,9 @@ struct PerfCountSet {
     T instructions{};
     T branchInstructions{};
     T branchMisses{};
+    T l1dMisses{};
+    T llcMisses{};
+    T dtlbMisses{};
 };
 
 } // namespace detail
@@ -389,6 +396,7 @@ struct Config {
     std::chrono::duration<double> mTimeUnit = std::chrono::nanoseconds{1};
     std::string mTimeUnitName = "ns";
     bool mShowPerformanceCounters = true;
+    bool mCacheCounters = false;
     bool mIsRelative = false;
 
     Config();
@@ -413,6 +421,9 @@ public:
         instructions,
         branchinstructions,
         branchmisses,
+        l1dmisses,
+        llcmisses,
+        dtlbmisses,
         _size
     };
 
@@ -849,6 +860,19 @@ public:
     Bench& performanceCounters(bool showPerformanceCounters) noexcept;
     ANKERL_NANOBENCH(NODISCARD) bool performanceCounters() const noexcept;
 
+    /**
+     * @brief Enables/disables cache and TLB miss counters.
+     *
+     * Counts L1 data cache, last level cache and data TLB read misses in a second counter group, off by default because
+     * many CPUs cannot schedule these next to the default counters and the kernel then multiplexes them (the counts are
+     * scaled by the time each group actually ran). The markdown output adds L1d/LLC/dTLB misses and the bytes the LLC
+     * misses moved (one 64 byte cache line per miss) per unit.
+     *
+     * @param enabled True to enable, false to disable.
+     */
+    Bench& cacheCounters(bool enabled) noexcept;
+    ANKERL_NANOBENCH(NODISCARD) bool cacheCounters() const noexcept;
+
     /**
      * @brief Retrieves all benchmark results collected by the bench object so far.
      *
@@ -1040,15 +1064,21 @@ public:
     void endMeasure();
     void updateResults(uint64_t numIters);
 
+    // the cache counter group is opened the first time it is enabled
+    void cacheCounters(bool enabled);
+
     ANKERL_NANOBENCH(NODISCARD) PerfCountSet<uint64_t> const& val() const noexcept;
     ANKERL_NANOBENCH(NODISCARD) PerfCountSet<bool> const& has() const noexcept;
 
 private:
 #if ANKERL_NANOBENCH(PERF_COUNTERS)
     LinuxPerformanceCounters* mPc = nullptr;
+    LinuxPerformanceCounters* mCachePc = nullptr;
 #endif
     PerfCountSet<uint64_t> mVal{};
     PerfCountSet<bool> mHas{};
+    PerfCountSet<bool> mCacheHas{};
+    bool mCacheEnabled = false;
 };
 ANKERL_NANOBENCH(IGNORE_PADDED_POP)
 
@@ -1400,6 +1430,9 @@ char const* json() noexcept {
             "median(pagefaults)": {{median(pagefaults)}},
             "median(branchinstructions)": {{median(branchinstructions)}},
             "median(branchmisses)": {{median(branchmisses)}},
+            "median(l1dmisses)": {{median(l1dmisses)}},
+            "median(llcmisses)": {{median(llcmisses)}},
+            "median(dtlbmisses)": {{median(dtlbmisses)}},
             "totalTime": {{sumProduct(iterations, elapsed)}},
             "measurements": [
 {{#measurement}}                {
@@ -1410,7 +1443,10 @@ char const* json() noexcept {
                     "contextswitches": {{contextswitches}},
                     "instructions": {{instructions}},
                     "branchinstructions": {{branchinstructions}},
-                    "branchmisses": {{branchmisses}}
+                    "branchmisses": {{branchmisses}},
+                    "l1dmisses": {{l1dmisses}},
+                    "llcmisses": {{llcmisses}},
+                    "dtlbmisses": {{dtlbmisses}}
                 }{{^-last}},{{/-last}}
 {{/measurement}}            ]
         }{{^-last}},{{/-last}}
@@ -2056,6 +2092,7 @@ struct IterationLogic::Impl {
         : mBench(bench)
         , mResult(bench.config()) {
         printStabilityInformationOnce(mBench.output());
+        performanceCounters().cacheCounters(mBench.cacheCounters());
 
         // determine target runtime per epoch
         mTargetRuntimePerEpoch = detail::clockResolution() * mBench.clockResolutionMultiple();
@@ -2230,6 +2267,17 @@ struct IterationLogic::Impl {
                     columns.emplace_back(10, 1, "miss%", "%", p);
                 }
             }
+            if (mResult.has(Result::Measure::l1dmisses)) {
+                columns.emplace_back(14, 2, "L1d/" + mBench.unit(), "", mResult.median(Result::Measure::l1dmisses) / mBench.batch());
+            }
+            if (mResult.has(Result::Measure::llcmisses)) {
+                double rLlcMedian = mResult.median(Result::Measure::llcmisses);
+                columns.emplace_back(14, 2, "LLC/" + mBench.unit(), "", rLlcMedian / mBench.batch());
+                columns.emplace_back(14, 1, "LLC B/" + mBench.unit(), "", rLlcMedian * 64.0 / mBench.batch());
+            }
+            if (mResult.has(Result::Measure::dtlbmisses)) {
+                columns.emplace_back(14, 2, "dTLB/" + mBench.unit(), "", mResult.median(Result::Measure::dtlbmisses) / mBench.batch());
+            }
 
             columns.emplace_back(12, 2, "total", "", mResult.sumProduct(Result::Measure::iterations, Result::Measure::elapsed));
 
@@ -2244,6 +2292,7 @@ struct IterationLogic::Impl {
             hash = hash_combine(std::hash<double>{}(mBench.timeUnit().count()), hash);
             hash = hash_combine(mBench.relative(), hash);
             hash = hash_combine(mBench.performanceCounters(), hash);
+            hash = hash_combine(mBench.cacheCounters(), hash);
 
             if (hash != singletonHeaderHash()) {
                 singletonHeaderHash() = hash;
@@ -2333,14 +2382,16 @@ ANKERL_NANOBENCH(IGNORE_PADDED_PUSH)
 class LinuxPerformanceCounters {
 public:
     struct Target {
-        Target(uint64_t* targetValue_, bool correctMeasuringOverhead_, bool correctLoopOverhead_)
+        Target(uint64_t* targetValue_, bool correctMeasuringOverhead_, bool correctLoopOverhead_, bool scaleMultiplexed_ = false)
             : targetValue(targetValue_)
             , correctMeasuringOverhead(correctMeasuringOverhead_)
-            , correctLoopOverhead(correctLoopOverhead_) {}
+            , correctLoopOverhead(correctLoopOverhead_)
+            , scaleMultiplexed(scaleMultiplexed_) {}
 
         uint64_t* targetValue{};
         bool correctMeasuringOverhead{};
         bool correctLoopOverhead{};
+        bool scaleMultiplexed{}; // scale by time enabled / time running when the kernel multiplexed the group
     };
 
     ~LinuxPerformanceCounters();
@@ -2352,6 +2403,7 @@ public:
 
     bool monitor(perf_sw_ids swId, Target target);
     bool monitor(perf_hw_id hwId, Target target);
+    bool monitor(perf_hw_cache_id cacheId, perf_hw_cache_op_id opId, perf_hw_cache_op_result_id resultId, Target target);
 
     bool hasError() const noexcept {
         return mHasError;
@@ -2504,6 +2556,11 @@ bool LinuxPerformanceCounters::monitor(perf_hw_id hwId, LinuxPerformanceCounters
     return monitor(PERF_TYPE_HARDWARE, hwId, target);
 }
 
+bool LinuxPerformanceCounters::monitor(perf_hw_cache_id cacheId, perf_hw_cache_op_id opId, perf_hw_cache_op_result_id resultId,
+                                       LinuxPerformanceCounters::Target target) {
+    return monitor(PERF_TYPE_HW_CACHE, cacheId | (opId << 8U) | (resultId << 16U), target);
+}
+
 // overflow is ok, it's checked
 ANKERL_NANOBENCH_NO_SANITIZE("integer")
 void LinuxPerformanceCounters::updateResults(uint64_t numIters) {
@@ -2543,6 +2600,11 @@ void LinuxPerformanceCounters::updateResults(uint64_t numIters) {
                     *tgt.targetValue = 0U;
                 }
             }
+            if (tgt.scaleMultiplexed && mTimeRunningNanos != 0U && mTimeRunningNanos < mTimeEnabledNanos) {
+                *tgt.targetValue = static_cast<uint64_t>(static_cast<double>(*tgt.targetValue) *
+                                                         static_cast<double>(mTimeEnabledNanos) /
+                                                         static_cast<double>(mTimeRunningNanos));
+            }
         }
     }
 }
@@ -2633,18 +2695,58 @@ PerformanceCounters::~PerformanceCounters() {
     if (nullptr != mPc) {
         delete mPc;
     }
+    if (nullptr != mCachePc) {
+        delete mCachePc;
+    }
+}
+
+void PerformanceCounters::cacheCounters(bool enabled) {
+    if (enabled && nullptr == mCachePc) {
+        mCachePc = new LinuxPerformanceCounters();
+        auto const read = PERF_COUNT_HW_CACHE_OP_READ;
+        auto const miss = PERF_COUNT_HW_CACHE_RESULT_MISS;
+        mCacheHas.l1dMisses =
+            mCachePc->monitor(PERF_COUNT_HW_CACHE_L1D, read, miss, LinuxPerformanceCounters::Target(&mVal.l1dMisses, true, false, true));
+        mCacheHas.llcMisses =
+            mCachePc->monitor(PERF_COUNT_HW_CACHE_LL, read, miss, LinuxPerformanceCounters::Target(&mVal.llcMisses, true, false, true));
+        mCacheHas.dtlbMisses =
+            mCachePc->monitor(PERF_COUNT_HW_CACHE_DTLB, read, miss, LinuxPerformanceCounters::Target(&mVal.dtlbMisses, true, false, true));
+        mCachePc->calibrate([] {
+            auto before = ankerl::nanobench::Clock::now();
+            auto after = ankerl::nanobench::Clock::now();
+            (void)before;
+            (void)after;
+        });
+        if (mCachePc->hasError()) {
+            mCacheHas = PerfCountSet<bool>{};
+        }
+    }
+    mCacheEnabled = enabled;
+    mHas.l1dMisses = enabled && mCacheHas.l1dMisses;
+    mHas.llcMisses = enabled && mCacheHas.llcMisses;
+    mHas.dtlbMisses = enabled && mCacheHas.dtlbMisses;
 }
 
+// the cache group brackets the default group
 void PerformanceCounters::beginMeasure() {
+    if (mCacheEnabled) {
+        mCachePc->beginMeasure();
+    }
     mPc->beginMeasure();
 }
 
 void PerformanceCounters::endMeasure() {
     mPc->endMeasure();
+    if (mCacheEnabled) {
+        mCachePc->endMeasure();
+    }
 }
 
 void PerformanceCounters::updateResults(uint64_t numIters) {
     mPc->updateResults(numIters);
+    if (mCacheEnabled) {
+        mCachePc->updateResults(numIters);
+    }
 }
 
 #    else
@@ -2654,6 +2756,7 @@ PerformanceCounters::~PerformanceCounters() = default;
 void PerformanceCounters::beginMeasure() {}
 void PerformanceCounters::endMeasure() {}
 void PerformanceCounters::updateResults(uint64_t) {}
+void PerformanceCounters::cacheCounters(bool) {}
 
 #    endif
 
@@ -2866,6 +2969,15 @@ void Result::add(Clock::duration totalElapsed, uint64_t iters, detail::Performan
             mNameToMeasurements[u(Result::Measure::branchmisses)].push_back(branchMisses / dIters);
         }
     }
+    if (pc.has().l1dMisses) {
+        mNameToMeasurements[u(Result::Measure::l1dmisses)].push_back(d(pc.val().l1dMisses) / dIters);
+    }
+    if (pc.has().llcMisses) {
+        mNameToMeasurements[u(Result::Measure::llcmisses)].push_back(d(pc.val().llcMisses) / dIters);
+    }
+    if (pc.has().dtlbMisses) {
+        mNameToMeasurements[u(Result::Measure::dtlbmisses)].push_back(d(pc.val().dtlbMisses) / dIters);
+    }
 }
 
 Config const& Result::config() const noexcept {
@@ -2995,6 +3107,12 @@ Result::Measure Result::fromString(std::string const& str) {
         return Measure::branchinstructions;
     } else if (str == "branchmisses") {
         return Measure::branchmisses;
+    } else if (str == "l1dmisses") {
+        return Measure::l1dmisses;
+    } else if (str == "llcmisses") {
+        return Measure::llcmisses;
+    } else if (str == "dtlbmisses") {
+        return Measure::dtlbmisses;
     } else {
         // not found, return _size
         return Measure::_size;
@@ -3038,6 +3156,14 @@ bool Bench::performanceCounters() const noexcept {
     return mConfig.mShowPerformanceCounters;
 }
 
+Bench& Bench::cacheCounters(bool enabled) noexcept {
+    mConfig.mCacheCounters = enabled;
+    return *this;
+}
+bool Bench::cacheCounters() const noexcept {
+    return mConfig.mCacheCounters;
+}
+
 // Operation unit. Defaults to "op", could be e.g. "byte" for string processing.
 // If u differs from currently set unit, the stored results will be cleared.
 // Use singular (byte, not bytes).
@@ -0,0 +1,273 @@
+#pragma once
+#include "bit_words.h"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <type_traits>
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2020 Alex Anderson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// packed_bits: the plain_array<bool, N> replacement, one bit per value in 64 bit words
+//  bits at or past size() are kept cleared so count() / find_first() / find_next() work a word at a time
+
+namespace containers {
+    template <::std::size_t N> struct packed_bits {
+      public:
+        using value_type      = bool;
+        using word_type       = ::std::uint64_t;
+        using size_type       = ::std::size_t;
+        using difference_type = ::std::ptrdiff_t;
+        using const_reference = bool;
+
+        static constexpr size_type word_bits  = bit_words::word_bits;
+        static constexpr size_type word_count = (N + word_bits - 1) / word_bits;
+
+        using reference = bit_words::reference;
+
+      private:
+        word_type _words[word_count > 0 ? word_count : 1]{};
+        size_type _size{0};
+
+        constexpr size_type used_words() const noexcept {
+            return bit_words::words_for(_size);
+        }
+        // clears every bit at or past size()
+        constexpr void trim() noexcept {
+            const size_type words = used_words();
+            if (_size % word_bits)
+                _words[words - 1] &= bit_words::range_mask(0, _size % word_bits);
+            for (size_type i = words; i < word_count; i++)
+                _words[i] = 0;
+        }
+
+      public:
+        constexpr packed_bits() noexcept : _size{0} {
+        }
+        constexpr explicit packed_bits(size_type count, bool value = false) noexcept {
+            assign(count, value);
+        }
+        constexpr packed_bits(::std::initializer_list<bool> init) noexcept {
+            for (bool value : init)
+                push_back(value);
+        }
+
+        constexpr void assign(size_type count, bool value) noexcept {
+            _size = count >= N ? N : count;
+            for (size_type i = 0; i < word_count; i++)
+                _words[i] = value ? ~word_type{0} : word_type{0};
+            trim();
+        }
+
+        //[]'s
+        [[nodiscard]] constexpr reference operator[](size_type pos) noexcept {
+            assert(pos < _size);
+            return reference{_words + bit_words::word_index(pos), bit_words::bit_mask(pos)};
+        };
+        [[nodiscard]] constexpr const_reference operator[](size_type pos) const noexcept {
+            assert(pos < _size);
+            return (_words[bit_words::word_index(pos)] & bit_words::bit_mask(pos)) != 0;
+        };
+        [[nodiscard]] constexpr bool test(size_type pos) const noexcept {
+            assert(pos < _size);
+            return (_words[bit_words::word_index(pos)] & bit_words::bit_mask(pos)) != 0;
+        }
+        // front
+        [[nodiscard]] constexpr reference front() noexcept {
+            return operator[](0);
+        };
+        [[nodiscard]] constexpr const_reference front() const noexcept {
+            return operator[](0);
+        };
+        // back's
+        [[nodiscard]] constexpr reference back() noexcept {
+            return operator[](_size - 1);
+        };
+        [[nodiscard]] constexpr const_reference back() const noexcept {
+            return operator[](_size - 1);
+        };
+
+        // data's, word_count() words of which the bits at or past size() are zero
+        [[nodiscard]] constexpr word_type *data() noexcept {
+            return _words;
+        };
+        [[nodiscard]] constexpr const word_type *data() const noexcept {
+            return _words;
+        };
+
+        // set / reset / flip's
+        constexpr void set(size_type pos, bool value = true) noexcept {
+            assert(pos < _size);
+            operator[](pos) = value;
+        }
+        constexpr void reset(size_type pos) noexcept {
+            assert(pos < _size);
+            _words[bit_words::word_index(pos)] &= ~bit_words::bit_mask(pos);
+        }
+        constexpr void flip(size_type pos) noexcept {
+            assert(pos < _size);
+            _words[bit_words::word_index(pos)] ^= bit_words::bit_mask(pos);
+        }
+        // bulk set / reset (non-standard), masks the edge words and writes whole words in between
+        constexpr void set_range(size_type first, size_type last) noexcept {
+            assert(first <= last && last <= _size);
+            bit_words::fill_range(_words, first, last, true);
+        }
+        constexpr void reset_range(size_type first, size_type last) noexcept {
+            assert(first <= last && last <= _size);
+            bit_words::fill_range(_words, first, last, false);
+        }
+        constexpr void set() noexcept {
+            bit_words::fill_range(_words, 0, _size, true);
+        }
+        constexpr void reset() noexcept {
+            bit_words::fill_range(_words, 0, _size, false);
+        }
+
+        // count (non-standard), number of set bits
+        [[nodiscard]] constexpr size_type count() const noexcept {
+            return bit_words::count(_words, used_words());
+        }
+        [[nodiscard]] constexpr bool any() const noexcept {
+            return bit_words::any(_words, used_words());
+        }
+        [[nodiscard]] constexpr bool none() const noexcept {
+            return !any();
+        }
+        [[nodiscard]] constexpr bool all() const noexcept {
+            return count() == _size;
+        }
+
+        // find_first (non-standard), index of the first set bit or size() if there is none
+        [[nodiscard]] constexpr size_type find_first() const noexcept {
+            return bit_words::find_from(_words, _size, 0);
+        }
+        // find_next (non-standard), index of the first set bit after pos or size() if there is none
+        [[nodiscard]] constexpr size_type find_next(size_type pos) const noexcept {
+            return bit_words::find_from(_words, _size, pos + 1);
+        }
+
+        // word at a time combination of masks of the same size
+        constexpr packed_bits &operator&=(const packed_bits &other) noexcept {
+            assert(_size == other._size);
+            for (size_type i = 0; i < word_count; i++)
+                _words[i] &= other._words[i];
+            return *this;
+        }
+        constexpr packed_bits &operator|=(const packed_bits &other) noexcept {
+            assert(_size == other._size);
+            for (size_type i = 0; i < word_count; i++)
+                _words[i] |= other._words[i];
+            return *this;
+        }
+        constexpr packed_bits &operator^=(const packed_bits &other) noexcept {
+            assert(_size == other._size);
+            for (size_type i = 0; i < word_count; i++)
+                _words[i] ^= other._words[i];
+            return *this;
+        }
+
+        constexpr reference emplace_back(bool value) noexcept {
+            if (_size < N) {
+                return unchecked_emplace_back(value);
+            } else {
+                return back();
+            }
+        }
+        // writes data to last index without checking on the size, quick but unsafe
+        constexpr reference unchecked_emplace_back(bool value) noexcept {
+            const size_type idx = _size;
+            _words[bit_words::word_index(idx)] |= static_cast<word_type>(value) << (idx % word_bits);
+            _size++;
+            return reference{_words + bit_words::word_index(idx), bit_words::bit_mask(idx)};
+        }
+        // push_back's
+        constexpr void push_back(bool value) noexcept {
+            emplace_back(value);
+        }
+        constexpr void unchecked_push_back(bool value) noexcept {
+            unchecked_emplace_back(value);
+        }
+
+        // pop_back's
+        constexpr void pop_back() noexcept {
+            if (_size) {
+                unchecked_pop_back();
+            }
+        }
+        constexpr void unchecked_pop_back() noexcept {
+            _size--;
+            _words[bit_words::word_index(_size)] &= ~bit_words::bit_mask(_size);
+        }
+
+        // resize (non-standard for plain_array), new bits take value
+        constexpr void resize(size_type count, bool value = false) noexcept {
+            count = count >= N ? N : count;
+            if (count > _size) {
+                const size_type first = _size;
+                _size                 = count;
+                bit_words::fill_range(_words, first, count, value);
+            } else {
+                _size = count;
+                trim();
+            }
+        }
+
+        // clear
+        constexpr void clear() noexcept {
+            for (size_type i = 0; i < word_count; i++)
+                _words[i] = 0;
+            _size = 0;
+        }
+
+        // empty
+        constexpr bool empty() const noexcept {
+            return _size == 0;
+        }
+        // capacity
+        constexpr size_type capacity() const noexcept {
+            return N;
+        }
+        // max_size
+        constexpr size_type max_size() const noexcept {
+            return N;
+        }
+        // size
+        constexpr size_type size() const noexcept {
+            return _size;
+        }
+
+        constexpr void swap(packed_bits &other) noexcept {
+            for (size_type i = 0; i < word_count; i++) {
+                word_type tmp   = _words[i];
+                _words[i]       = other._words[i];
+                other._words[i] = tmp;
+            }
+            size_type tmp = _size;
+            _size         = other._size;
+            other._size   = tmp;
+        }
+    };
+} // namespace containers
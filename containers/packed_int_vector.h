@@ -0,0 +1,372 @@
+#pragma once
+#include "real_vector.h"
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2021 Alex Anderson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// packed_int_vector<Bits>: unsigned integers of Bits bits each, packed back to back into a real::vector<uint64_t>
+//  value i occupies bits [i * Bits, (i + 1) * Bits) of the little endian word stream, get(i) is one unaligned
+//  8 byte load, a shift and a mask (for Bits <= 57, wider values read two words), one zero word of padding at
+//  the end keeps the load inside the allocation
+//  decode(first, last, out) unpacks a range in one loop the compiler vectorizes, with AVX2 enabled (-mavx2) it
+//  gathers 4 values per instruction
+// delta_int_vector: non-decreasing integers (sorted ids) as blocks of 128, each block keeps its first value and
+//  the deltas between neighbours packed at the width of the block's largest delta (frame of reference on deltas),
+//  the block being filled stays unpacked until it's full, get(i) sums up to 127 deltas, decode is the fast path
+//
+//	real::packed_int_vector<20> ids; // 20 bits per value instead of 64
+//	ids.push_back(123456);
+//	ids.decode(0, ids.size(), buffer);
+
+namespace real {
+	namespace details {
+		[[nodiscard]] constexpr uint64_t low_bits_mask(unsigned bits) noexcept {
+			return bits >= 64 ? ~uint64_t{0} : (uint64_t{1} << bits) - 1;
+		}
+
+		// the value of bits bits starting at bit, words must have a readable word past the last value
+		[[nodiscard]] inline uint64_t packed_load(const uint64_t *words, size_t bit, unsigned bits) noexcept {
+			if constexpr (::std::endian::native == ::std::endian::little) {
+				if (bits <= 57) {
+					uint64_t value;
+					::std::memcpy(&value, reinterpret_cast<const unsigned char *>(words) + bit / 8, sizeof(value));
+					return (value >> (bit % 8)) & low_bits_mask(bits);
+				}
+			}
+			const size_t   word   = bit / 64;
+			const unsigned offset = static_cast<unsigned>(bit % 64);
+			uint64_t       value  = words[word] >> offset;
+			if (offset && offset + bits > 64)
+				value |= words[word + 1] << (64 - offset);
+			return value & low_bits_mask(bits);
+		}
+
+		// or's value in, the bits must be clear
+		inline void packed_store(uint64_t *words, size_t bit, unsigned bits, uint64_t value) noexcept {
+			const size_t   word   = bit / 64;
+			const unsigned offset = static_cast<unsigned>(bit % 64);
+			words[word] |= value << offset;
+			if (offset && offset + bits > 64)
+				words[word + 1] |= value >> (64 - offset);
+		}
+
+		inline void packed_clear(uint64_t *words, size_t bit, unsigned bits) noexcept {
+			const size_t   word   = bit / 64;
+			const unsigned offset = static_cast<unsigned>(bit % 64);
+			words[word] &= ~(low_bits_mask(bits) << offset);
+			if (offset && offset + bits > 64)
+				words[word + 1] &= ~(low_bits_mask(bits) >> (64 - offset));
+		}
+
+		// count values of bits bits from first_bit on into out
+		inline void packed_unpack(const uint64_t *words, size_t first_bit, unsigned bits, size_t count,
+		                          uint64_t *out) noexcept {
+			size_t i = 0;
+#if defined(__AVX2__)
+			if constexpr (::std::endian::native == ::std::endian::little) {
+				if (bits <= 57 && count >= 4) {
+					// 4 lanes of bit positions, gathered at their byte and shifted by the rest
+					const __m256i step  = _mm256_set1_epi64x(static_cast<long long>(4 * bits));
+					const __m256i mask  = _mm256_set1_epi64x(static_cast<long long>(low_bits_mask(bits)));
+					const __m256i seven = _mm256_set1_epi64x(7);
+					__m256i       pos   = _mm256_add_epi64(_mm256_set1_epi64x(static_cast<long long>(first_bit)),
+					                                       _mm256_set_epi64x(3ll * bits, 2ll * bits, 1ll * bits, 0));
+					const long long *base = reinterpret_cast<const long long *>(words);
+					for (; i + 4 <= count; i += 4) {
+						const __m256i bytes  = _mm256_srli_epi64(pos, 3);
+						const __m256i shifts = _mm256_and_si256(pos, seven);
+						const __m256i loaded = _mm256_i64gather_epi64(base, bytes, 1);
+						_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+						                    _mm256_and_si256(_mm256_srlv_epi64(loaded, shifts), mask));
+						pos = _mm256_add_epi64(pos, step);
+					}
+				}
+			}
+#endif
+			for (; i < count; i++)
+				out[i] = packed_load(words, first_bit + i * bits, bits);
+		}
+
+		struct delta_block {
+			uint64_t base;       // the first value
+			uint64_t first_word; // where the deltas start in the word stream
+			uint32_t bits;       // width of every delta, 0 when the block is one value repeated
+		};
+	} // namespace details
+
+	template <unsigned Bits, typename Allocator = ::std::allocator<uint64_t>> class packed_int_vector {
+		static_assert(Bits >= 1 && Bits <= 64, "packed_int_vector holds 1 to 64 bit values");
+
+	  public:
+		using value_type     = uint64_t;
+		using word_type      = uint64_t;
+		using size_type      = ::std::size_t;
+		using allocator_type = Allocator;
+
+		static constexpr unsigned   bits      = Bits;
+		static constexpr value_type max_value = details::low_bits_mask(Bits);
+
+	  private:
+		vector<word_type, Allocator> _words;
+		size_type                    _size = 0;
+
+		// words holding count values plus the padding word
+		[[nodiscard]] static constexpr size_type _words_for(size_type count) noexcept {
+			return (count * Bits + 63) / 64 + 1;
+		}
+		void _make_room(size_type count) {
+			const size_type words = _words_for(count);
+			if (_words.size() < words)
+				_words.insert(_words.end(), words - _words.size(), word_type{0});
+		}
+
+	  public:
+		packed_int_vector() = default;
+		explicit packed_int_vector(const Allocator &alloc) : _words(alloc) {
+		}
+
+		[[nodiscard]] size_type size() const noexcept {
+			return _size;
+		}
+		[[nodiscard]] bool empty() const noexcept {
+			return _size == 0;
+		}
+		[[nodiscard]] size_type capacity() const noexcept {
+			return _words.capacity() ? (_words.capacity() - 1) * 64 / Bits : 0;
+		}
+		void reserve(size_type count) {
+			_words.reserve(_words_for(count));
+		}
+		// bytes of packed storage in use
+		[[nodiscard]] size_type bytes() const noexcept {
+			return _words.size() * sizeof(word_type);
+		}
+		[[nodiscard]] const word_type *data() const noexcept {
+			return _words.data();
+		}
+
+		[[nodiscard]] value_type get(size_type pos) const noexcept {
+			assert(pos < _size);
+			return details::packed_load(_words.data(), pos * Bits, Bits);
+		}
+		[[nodiscard]] value_type operator[](size_type pos) const noexcept {
+			return get(pos);
+		}
+		[[nodiscard]] value_type at(size_type pos) const {
+			if (!(pos < _size))
+				throw ::std::out_of_range("accessing index out of range of packed_int_vector");
+			return get(pos);
+		}
+		[[nodiscard]] value_type back() const noexcept {
+			return get(_size - 1);
+		}
+
+		// value must fit in Bits bits
+		void set(size_type pos, value_type value) noexcept {
+			assert(pos < _size && value <= max_value);
+			details::packed_clear(_words.data(), pos * Bits, Bits);
+			details::packed_store(_words.data(), pos * Bits, Bits, value & max_value);
+		}
+
+		void push_back(value_type value) {
+			assert(value <= max_value && "value does not fit in Bits bits");
+			_make_room(_size + 1);
+			details::packed_store(_words.data(), _size * Bits, Bits, value & max_value);
+			_size += 1;
+		}
+
+		void pop_back() noexcept {
+			assert(_size && "pop_back on an empty packed_int_vector");
+			_size -= 1;
+			details::packed_clear(_words.data(), _size * Bits, Bits);
+		}
+
+		// new values are 0
+		void resize(size_type count) {
+			if (count > _size) {
+				_make_room(count);
+			} else {
+				while (_size > count)
+					pop_back();
+			}
+			_size = count;
+		}
+
+		void clear() noexcept {
+			_words.clear();
+			_size = 0;
+		}
+
+		// writes the values [first, last) to out, returns the end of what was written
+		template <typename Out> Out *decode(size_type first, size_type last, Out *out) const {
+			assert(first <= last && last <= _size);
+			if constexpr (::std::is_same<Out, uint64_t>::value) {
+				details::packed_unpack(_words.data(), first * Bits, Bits, last - first, out);
+				return out + (last - first);
+			} else {
+				for (size_type i = first; i < last; i++)
+					*out++ = static_cast<Out>(details::packed_load(_words.data(), i * Bits, Bits));
+				return out;
+			}
+		}
+	};
+
+	template <typename Allocator = ::std::allocator<uint64_t>> class delta_int_vector {
+	  public:
+		using value_type     = uint64_t;
+		using word_type      = uint64_t;
+		using size_type      = ::std::size_t;
+		using allocator_type = Allocator;
+
+		static constexpr size_type block_size = 128;
+
+	  private:
+		using block_allocator = typename ::std::allocator_traits<Allocator>::template rebind_alloc<details::delta_block>;
+
+		vector<word_type, Allocator>                    _words;
+		vector<details::delta_block, block_allocator> _blocks;
+		value_type                                      _tail[block_size];
+		size_type                                       _tail_size = 0;
+		size_type                                       _size      = 0;
+
+		// packs the full tail into a block
+		void _seal() {
+			uint64_t largest = 0;
+			for (size_type i = 1; i < block_size; i++)
+				largest = _tail[i] - _tail[i - 1] > largest ? _tail[i] - _tail[i - 1] : largest;
+			const unsigned bits = static_cast<unsigned>(::std::bit_width(largest));
+
+			// the padding word at the end of the stream becomes the first word of the block
+			const size_type first_word = _words.empty() ? 0 : _words.size() - 1;
+			const size_type words      = ((block_size - 1) * bits + 63) / 64;
+			_words.insert(_words.end(), first_word + words + 1 - _words.size(), word_type{0});
+			for (size_type i = 1; bits && i < block_size; i++)
+				details::packed_store(_words.data() + first_word, (i - 1) * bits, bits, _tail[i] - _tail[i - 1]);
+			_blocks.push_back({_tail[0], first_word, bits});
+			_tail_size = 0;
+		}
+
+		// the values of sealed block b into out[0, block_size)
+		void _decode_block(size_type b, value_type *out) const noexcept {
+			const details::delta_block &block = _blocks[b];
+			out[0]                            = block.base;
+			if (!block.bits) {
+				for (size_type i = 1; i < block_size; i++)
+					out[i] = block.base;
+				return;
+			}
+			details::packed_unpack(_words.data() + block.first_word, 0, block.bits, block_size - 1, out + 1);
+			for (size_type i = 1; i < block_size; i++)
+				out[i] += out[i - 1];
+		}
+
+	  public:
+		delta_int_vector() = default;
+		explicit delta_int_vector(const Allocator &alloc) : _words(alloc), _blocks(block_allocator(alloc)) {
+		}
+
+		[[nodiscard]] size_type size() const noexcept {
+			return _size;
+		}
+		[[nodiscard]] bool empty() const noexcept {
+			return _size == 0;
+		}
+		// bytes of packed storage and block headers in use (the unpacked tail not included)
+		[[nodiscard]] size_type bytes() const noexcept {
+			return _words.size() * sizeof(word_type) + _blocks.size() * sizeof(details::delta_block);
+		}
+
+		[[nodiscard]] value_type back() const noexcept {
+			assert(_size);
+			return _tail_size ? _tail[_tail_size - 1] : get(_size - 1);
+		}
+
+		// throws std::invalid_argument when value is smaller than back()
+		void push_back(value_type value) {
+			if (_size && value < back())
+				throw ::std::invalid_argument("delta_int_vector values must not decrease");
+			_tail[_tail_size++] = value;
+			_size += 1;
+			if (_tail_size == block_size)
+				_seal();
+		}
+
+		// base of the block plus the deltas up to pos
+		[[nodiscard]] value_type get(size_type pos) const noexcept {
+			assert(pos < _size);
+			const size_type b = pos / block_size;
+			const size_type r = pos % block_size;
+			if (b == _blocks.size())
+				return _tail[r];
+			const details::delta_block &block = _blocks[b];
+			value_type                  value = block.base;
+			for (size_type i = 0; block.bits && i < r; i++)
+				value += details::packed_load(_words.data() + block.first_word, i * block.bits, block.bits);
+			return value;
+		}
+		[[nodiscard]] value_type operator[](size_type pos) const noexcept {
+			return get(pos);
+		}
+
+		void clear() noexcept {
+			_words.clear();
+			_blocks.clear();
+			_tail_size = 0;
+			_size      = 0;
+		}
+
+		// writes the values [first, last) to out, returns the end of what was written
+		value_type *decode(size_type first, size_type last, value_type *out) const {
+			assert(first <= last && last <= _size);
+			value_type buffer[block_size];
+			while (first < last) {
+				const size_type b     = first / block_size;
+				const size_type r     = first % block_size;
+				const size_type count = block_size - r < last - first ? block_size - r : last - first;
+				if (b == _blocks.size()) {
+					::std::memcpy(out, _tail + r, count * sizeof(value_type));
+				} else if (r == 0 && count == block_size) {
+					_decode_block(b, out);
+				} else {
+					_decode_block(b, buffer);
+					::std::memcpy(out, buffer + r, count * sizeof(value_type));
+				}
+				out += count;
+				first += count;
+			}
+			return out;
+		}
+	};
+} // namespace real
@@ -1,7 +1,12 @@
 #pragma once
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <functional>
 #include <iterator>
+#include <limits>
 #include <type_traits>
+#include <utility>
 
 #if defined(_MSC_VER)
 #define MUST_INLINE __forceinline
@@ -48,6 +53,142 @@ SOFTWARE.
 */
 
 namespace containers {
+    namespace details {
+        struct comparator {
+            size_t lo;
+            size_t hi;
+        };
+
+        // selects the storage constructor that leaves the values for the caller to write
+        struct uninitialized_t {};
+
+        // Batcher's odd-even merge sort, comparators reaching past n are dropped which works
+        // for any n (the missing values behave as if they were larger than everything else)
+        template <typename Fn> constexpr void for_each_odd_even_merge_comparator(size_t n, Fn fn) {
+            for (size_t p = 1; p < n; p <<= 1) {
+                for (size_t k = p; k >= 1; k >>= 1) {
+                    for (size_t j = k % p; j + k < n; j += 2 * k) {
+                        for (size_t i = 0; i < k && (i + j + k) < n; i++) {
+                            if ((i + j) / (2 * p) == (i + j + k) / (2 * p))
+                                fn(i + j, i + j + k);
+                        }
+                    }
+                }
+            }
+        }
+
+        constexpr size_t odd_even_merge_comparator_count(size_t n) {
+            size_t count = 0;
+            for_each_odd_even_merge_comparator(n, [&count](size_t, size_t) { count++; });
+            return count;
+        }
+
+        template <size_t N> struct odd_even_merge_network {
+            static constexpr size_t size = odd_even_merge_comparator_count(N);
+            comparator              pairs[size > 0 ? size : 1]{};
+
+            constexpr odd_even_merge_network() {
+                size_t idx = 0;
+                for_each_odd_even_merge_comparator(N, [this, &idx](size_t lo, size_t hi) {
+                    pairs[idx].lo = lo;
+                    pairs[idx].hi = hi;
+                    idx++;
+                });
+            }
+        };
+
+        template <size_t N> inline constexpr odd_even_merge_network<N> odd_even_merge_network_v{};
+
+        // networks are used up to this capacity, past it the comparator count grows too quickly
+        inline constexpr size_t sorting_network_limit = 32;
+
+        template <typename T, typename Compare>
+        inline constexpr bool is_network_sortable =
+            ::std::is_arithmetic<T>::value &&
+            (::std::is_same<Compare, ::std::less<T>>::value || ::std::is_same<Compare, ::std::less<>>::value);
+
+        // min / max without branches, compilers emit cmov or (v)min / (v)max for these
+        template <typename T> constexpr MUST_INLINE void compare_exchange(T &left, T &right) {
+            const T    a       = left;
+            const T    b       = right;
+            const bool swapped = b < a;
+            left               = swapped ? b : a;
+            right              = swapped ? a : b;
+        }
+
+        // fully unrolled, every comparator index is a constant
+        template <size_t N, typename T, size_t... Idxs>
+        constexpr MUST_INLINE void apply_network(T *first, ::std::index_sequence<Idxs...>) {
+            (compare_exchange(first[odd_even_merge_network_v<N>.pairs[Idxs].lo],
+                              first[odd_even_merge_network_v<N>.pairs[Idxs].hi]),
+             ...);
+        }
+
+        template <typename T, typename Compare>
+        constexpr void insertion_sort(T *first, size_t count, Compare &comp) {
+            for (size_t i = 1; i < count; i++) {
+                T      value = ::std::move(first[i]);
+                size_t j     = i;
+                for (; j > 0 && comp(value, first[j - 1]); j--)
+                    first[j] = ::std::move(first[j - 1]);
+                first[j] = ::std::move(value);
+            }
+        }
+
+        // sorts [first, first + count) where first points at storage for N values
+        template <size_t N, typename T, typename Compare>
+        constexpr void small_sort(T *first, size_t count, Compare &comp) {
+            if constexpr (is_network_sortable<T, Compare>) {
+                if constexpr (N <= sorting_network_limit) {
+                    if (count > 8) {
+                        // pad the unused slots so a single fixed network sorts any size
+                        T sentinel = ::std::numeric_limits<T>::has_infinity ? ::std::numeric_limits<T>::infinity()
+                                                                            : ::std::numeric_limits<T>::max();
+                        for (size_t i = count; i < N; i++)
+                            first[i] = sentinel;
+                        apply_network<N>(first, ::std::make_index_sequence<odd_even_merge_network<N>::size>{});
+                        return;
+                    }
+                }
+                if (count <= 8) {
+                    for (size_t i = 1; i < count; i++)
+                        for (size_t j = i; j > 0; j--)
+                            compare_exchange(first[j - 1], first[j]);
+                    return;
+                }
+            }
+#if __cplusplus_version > 201703L && __cpp_lib_constexpr_algorithms >= 201806L
+            if (count > 16) {
+                ::std::sort(first, first + count, comp);
+                return;
+            }
+#endif
+            insertion_sort(first, count, comp);
+        }
+
+        template <size_t N, typename T, typename Compare>
+        constexpr void small_partial_sort(T *first, size_t middle, size_t count, Compare &comp) {
+#if __cplusplus_version > 201703L && __cpp_lib_constexpr_algorithms >= 201806L
+            if (count > 16 && !(is_network_sortable<T, Compare> && N <= sorting_network_limit)) {
+                ::std::partial_sort(first, first + middle, first + count, comp);
+                return;
+            }
+#endif
+            small_sort<N>(first, count, comp);
+        }
+
+        template <size_t N, typename T, typename Compare>
+        constexpr void small_nth_element(T *first, size_t nth, size_t count, Compare &comp) {
+#if __cplusplus_version > 201703L && __cpp_lib_constexpr_algorithms >= 201806L
+            if (count > 16 && !(is_network_sortable<T, Compare> && N <= sorting_network_limit)) {
+                ::std::nth_element(first, first + nth, first + count, comp);
+                return;
+            }
+#endif
+            small_sort<N>(first, count, comp);
+        }
+    } // namespace details
+
     template <typename Ty, size_t N> struct plain_array {
       public:
         using element_type           = Ty;
@@ -64,7 +205,23 @@ namespace containers {
         using const_reverse_iterator = ::std::reverse_iterator<const_iterator>;
 
         struct storage {
-            value_type                  _values[N]{};
+            value_type _values[N];
+
+            constexpr storage() : _values{} {
+            }
+            // copies and moves write their values after this, only constant evaluation (which cannot read an
+            //  uninitialized value) still pays for all of them
+#if __cpp_lib_is_constant_evaluated >= 201811L
+            constexpr explicit storage(details::uninitialized_t) {
+                if (::std::is_constant_evaluated())
+                    for (size_t i = 0; i < N; i++)
+                        _values[i] = value_type();
+            }
+#else
+            constexpr explicit storage(details::uninitialized_t) : _values{} {
+            }
+#endif
+
             constexpr const value_type *data() const {
                 return _values;
             }
@@ -74,6 +231,9 @@ namespace containers {
         };
 
         struct empty_storage {
+            constexpr empty_storage() = default;
+            constexpr explicit empty_storage(details::uninitialized_t) {
+            }
             constexpr const value_type *data() const {
                 return nullptr;
             }
@@ -146,6 +306,29 @@ namespace containers {
 #endif
         }
 
+        static constexpr MUST_INLINE iterator move(iterator first, iterator last, iterator d_first) {
+#if __cplusplus_version > 201703L && __cpp_lib_constexpr_algorithms >= 201806L
+            return ::std::move(first, last, d_first); // cross fingers this should be optimized
+#else
+            while (first != last) { // fallback
+                *d_first++ = ::std::move(*first++);
+            }
+            return d_first;
+#endif
+        }
+
+        static constexpr MUST_INLINE iterator move_backward(iterator first, iterator last, iterator d_last) {
+#if __cplusplus_version > 201703L && __cpp_lib_constexpr_algorithms >= 201806L
+            return ::std::move_backward(first, last, d_last); // cross fingers this should be optimized
+#else
+            // fallback
+            while (first != last) {
+                *(--d_last) = ::std::move(*(--last));
+            }
+            return d_last;
+#endif
+        }
+
         static constexpr MUST_INLINE void swap(value_type &left, value_type &right) {
 #if __cplusplus_version > 201703L && __cpp_lib_constexpr_algorithms >= 201806L
             ::std::swap(left, right); // cross fingers this should be optimized
@@ -182,6 +365,35 @@ namespace containers {
 #endif
         }
 
+        // copies count values, memcpy for trivially copyable types outside of constant evaluation
+        static constexpr MUST_INLINE void copy_values(const value_type *first, size_t count, value_type *d_first) {
+#if __cpp_lib_is_constant_evaluated >= 201811L
+            if constexpr (::std::is_trivially_copyable<value_type>::value) {
+                if (!::std::is_constant_evaluated()) {
+                    if (count)
+                        ::std::memcpy(d_first, first, count * sizeof(value_type));
+                    return;
+                }
+            }
+#endif
+            for (size_t i = 0; i < count; i++)
+                d_first[i] = first[i];
+        }
+
+        static constexpr MUST_INLINE void move_values(value_type *first, size_t count, value_type *d_first) {
+#if __cpp_lib_is_constant_evaluated >= 201811L
+            if constexpr (::std::is_trivially_copyable<value_type>::value) {
+                if (!::std::is_constant_evaluated()) {
+                    if (count)
+                        ::std::memcpy(d_first, first, count * sizeof(value_type));
+                    return;
+                }
+            }
+#endif
+            for (size_t i = 0; i < count; i++)
+                d_first[i] = ::std::move(first[i]);
+        }
+
       private:
         data_t _data;
         size_t _size{0};
@@ -198,11 +410,13 @@ namespace containers {
         template <typename It, typename It2> constexpr plain_array(It first, It last) {
             assign(first, last);
         }
-        constexpr plain_array(const plain_array &other) {
-            assign(other.begin(), other.end());
+        constexpr plain_array(const plain_array &other)
+            : _data{details::uninitialized_t{}}, _size{other._size} {
+            copy_values(other.data(), other._size, data());
         }
-        constexpr plain_array(plain_array &&other) noexcept {
-            assign(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+        constexpr plain_array(plain_array &&other) noexcept
+            : _data{details::uninitialized_t{}}, _size{other._size} {
+            move_values(other.data(), other._size, data());
         }
         constexpr plain_array(::std::initializer_list<value_type> init) {
             assign(init.begin(), init.end());
@@ -272,14 +486,16 @@ namespace containers {
         constexpr plain_array &operator=(const plain_array &other) {
             if (this == &other)
                 return *this;
-            plain_array(other.begin(), other.end());
+            copy_values(other.data(), other._size, data());
+            _size = other._size;
             return *this;
         }
 
         constexpr plain_array &operator=(plain_array &&other) noexcept {
             if (this == &other)
                 return *this;
-            plain_array(std::forward<plain_array &&>(other));
+            move_values(other.data(), other._size, data());
+            _size = other._size;
             return *this;
         }
 
@@ -415,12 +631,12 @@ namespace containers {
         // pop_front's (non-standard)
         constexpr void pop_front() {
             if (_size) {
-                copy(begin() + 1, end(), begin());
+                move(begin() + 1, end(), begin());
                 _size--;
             }
         }
         constexpr void unchecked_pop_front() {
-            copy(begin() + 1, end(), begin());
+            move(begin() + 1, end(), begin());
             _size--;
         }
 
@@ -428,7 +644,7 @@ namespace containers {
             if (_size) {
                 size_t erase_idx = pos - cbegin();
                 if (erase_idx < _size) {
-                    copy(begin() + erase_idx + 1, end(), begin() + erase_idx);
+                    move(begin() + erase_idx + 1, end(), begin() + erase_idx);
                     _size--;
                     return begin() + erase_idx;
                 }
@@ -452,7 +668,7 @@ namespace containers {
                     iterator l = begin() + last_idx;
                     // a b c d - - - h i j k _ _ _ _
                     // a b c d h i j k _ _ _ _ _ _ _
-                    iterator c = copy(l, end(), f);
+                    iterator c = move(l, end(), f);
                     _size      = c - begin();
                     return begin() + erase_idx;
                 }
@@ -475,7 +691,7 @@ namespace containers {
                     return ret;
                 }
                 // move backwards
-                copy_backward(begin() + insert_idx, end(), end() + 1);
+                move_backward(begin() + insert_idx, end(), end() + 1);
                 // construct* inplace
                 data()[insert_idx] = value_type(std::forward<Args>(args)...);
                 _size += 1;
@@ -513,7 +729,7 @@ namespace containers {
                 }
                 size_t remaining    = N - _size;
                 size_t insert_count = count <= remaining ? count : remaining;
-                copy_backward(begin() + insert_idx, begin() + _size, begin() + (insert_count + _size));
+                move_backward(begin() + insert_idx, begin() + _size, begin() + (insert_count + _size));
                 fill(begin() + insert_idx, begin() + (insert_idx + insert_count), value);
                 _size += insert_count;
                 return ret;
@@ -537,6 +753,11 @@ namespace containers {
                     _size += insert_count;
                     return ret;
                 }
+#if __cpp_lib_is_constant_evaluated >= 201811L
+                // same result for a fraction of the constant evaluation steps
+                if (::std::is_constant_evaluated())
+                    return insert_backwards(pos, count, value);
+#endif
                 size_t remaining    = N - _size;
                 size_t insert_count = count <= remaining ? count : remaining;
 
@@ -552,7 +773,7 @@ namespace containers {
         }
 
         template <typename It, typename It2,
-                  typename std::enable_if<!std::is_convertible<It, size_type>::value>::type>
+                  typename = typename std::enable_if<!std::is_convertible<It, size_type>::value>::type>
         constexpr iterator insert(const_iterator pos, It first, It2 last) {
             if (_size < N) { //
                 size_t insert_idx = pos - cbegin();
@@ -565,13 +786,28 @@ namespace containers {
                         unchecked_emplace_back(*first);
                     return ret;
                 }
-                size_t mid_insert = _size;
-                for (; _size < N && first != last; ++first)
-                    unchecked_emplace_back(*first);
-                // size_t last_insert = _size;
-                // rotate algorithm
-                rotate(begin() + insert_idx, begin() + mid_insert, begin() + _size);
-                return ret;
+                if constexpr (::std::is_same<It, It2>::value &&
+                              ::std::is_base_of<::std::forward_iterator_tag,
+                                                typename ::std::iterator_traits<It>::iterator_category>::value) {
+                    // multi-pass ranges shift the tail once, a rotate moves every value about twice
+                    // (the difference dominates constant evaluation of large arrays)
+                    const size_t remaining    = N - _size;
+                    const size_t distance     = static_cast<size_t>(::std::distance(first, last));
+                    const size_t insert_count = distance <= remaining ? distance : remaining;
+                    move_backward(begin() + insert_idx, end(), end() + insert_count);
+                    for (size_t i = 0; i < insert_count; ++i, ++first)
+                        data()[insert_idx + i] = *first;
+                    _size += insert_count;
+                    return ret;
+                } else {
+                    size_t mid_insert = _size;
+                    for (; _size < N && first != last; ++first)
+                        unchecked_emplace_back(*first);
+                    // size_t last_insert = _size;
+                    // rotate algorithm
+                    rotate(begin() + insert_idx, begin() + mid_insert, begin() + _size);
+                    return ret;
+                }
             } else {
                 return end();
             }
@@ -579,7 +815,7 @@ namespace containers {
 
         // append (non-standard)
         template <typename It, typename It2,
-                  typename std::enable_if<
+                  typename = typename std::enable_if<
                       !std::is_same<typename std::iterator_traits<It>::value_type, void>::value>::type>
         constexpr iterator append(It first, It2 last) {
             if (_size < N) {
@@ -612,9 +848,42 @@ namespace containers {
             }
         }
 
+        // sort's (non-standard), small sizes are sorted by a sorting network fixed at compile time for N
+        constexpr void sort() {
+            sort(::std::less<value_type>{});
+        }
+        template <typename Compare> constexpr void sort(Compare comp) {
+            details::small_sort<N>(data(), _size, comp);
+        }
+
+        // partial_sort (non-standard), [begin(), middle) receive the smallest values in order
+        constexpr void partial_sort(const_iterator middle) {
+            partial_sort(middle, ::std::less<value_type>{});
+        }
+        template <typename Compare> constexpr void partial_sort(const_iterator middle, Compare comp) {
+            details::small_partial_sort<N>(data(), static_cast<size_t>(middle - cbegin()), _size, comp);
+        }
+
+        // nth_element (non-standard)
+        constexpr void nth_element(const_iterator nth) {
+            nth_element(nth, ::std::less<value_type>{});
+        }
+        template <typename Compare> constexpr void nth_element(const_iterator nth, Compare comp) {
+            details::small_nth_element<N>(data(), static_cast<size_t>(nth - cbegin()), _size, comp);
+        }
+
+        // only touches max(size(), other.size()) values
         constexpr void swap(plain_array &other) noexcept(true) {
             if constexpr (N > 0) {
-                swap(_data._values, other._data._values);
+                if (this == &other)
+                    return;
+                plain_array &longer  = _size < other._size ? other : *this;
+                plain_array &shorter = _size < other._size ? *this : other;
+                value_type  *first1  = shorter.data();
+                value_type  *first2  = longer.data();
+                for (size_t i = 0; i < shorter._size; i++)
+                    swap(first1[i], first2[i]);
+                move_values(first2 + shorter._size, longer._size - shorter._size, first1 + shorter._size);
                 size_t tmp  = _size;
                 _size       = other._size;
                 other._size = tmp;
@@ -638,7 +907,23 @@ namespace containers {
         using const_reverse_iterator = ::std::reverse_iterator<const_iterator>;
 
         struct storage {
-            value_type                  _values[N + 1]{};
+            value_type _values[N + 1];
+
+            constexpr storage() : _values{} {
+            }
+            // copies and moves write their values after this, only constant evaluation (which cannot read an
+            //  uninitialized value) still pays for all of them
+#if __cpp_lib_is_constant_evaluated >= 201811L
+            constexpr explicit storage(details::uninitialized_t) {
+                if (::std::is_constant_evaluated())
+                    for (size_t i = 0; i < N + 1; i++)
+                        _values[i] = value_type();
+            }
+#else
+            constexpr explicit storage(details::uninitialized_t) : _values{} {
+            }
+#endif
+
             constexpr const value_type *data() const {
                 return _values;
             }
@@ -711,6 +996,29 @@ namespace containers {
 #endif
         }
 
+        static constexpr MUST_INLINE iterator move(iterator first, iterator last, iterator d_first) {
+#if __cplusplus_version > 201703L && __cpp_lib_constexpr_algorithms >= 201806L
+            return ::std::move(first, last, d_first); // cross fingers this should be optimized
+#else
+            while (first != last) { // fallback
+                *d_first++ = ::std::move(*first++);
+            }
+            return d_first;
+#endif
+        }
+
+        static constexpr MUST_INLINE iterator move_backward(iterator first, iterator last, iterator d_last) {
+#if __cplusplus_version > 201703L && __cpp_lib_constexpr_algorithms >= 201806L
+            return ::std::move_backward(first, last, d_last); // cross fingers this should be optimized
+#else
+            // fallback
+            while (first != last) {
+                *(--d_last) = ::std::move(*(--last));
+            }
+            return d_last;
+#endif
+        }
+
         static constexpr MUST_INLINE void swap(value_type &left, value_type &right) {
 #if __cplusplus_version > 201703L && __cpp_lib_constexpr_algorithms >= 201806L
             ::std::swap(left, right); // cross fingers this should be optimized
@@ -747,6 +1055,35 @@ namespace containers {
 #endif
         }
 
+        // copies count values, memcpy for trivially copyable types outside of constant evaluation
+        static constexpr MUST_INLINE void copy_values(const value_type *first, size_t count, value_type *d_first) {
+#if __cpp_lib_is_constant_evaluated >= 201811L
+            if constexpr (::std::is_trivially_copyable<value_type>::value) {
+                if (!::std::is_constant_evaluated()) {
+                    if (count)
+                        ::std::memcpy(d_first, first, count * sizeof(value_type));
+                    return;
+                }
+            }
+#endif
+            for (size_t i = 0; i < count; i++)
+                d_first[i] = first[i];
+        }
+
+        static constexpr MUST_INLINE void move_values(value_type *first, size_t count, value_type *d_first) {
+#if __cpp_lib_is_constant_evaluated >= 201811L
+            if constexpr (::std::is_trivially_copyable<value_type>::value) {
+                if (!::std::is_constant_evaluated()) {
+                    if (count)
+                        ::std::memcpy(d_first, first, count * sizeof(value_type));
+                    return;
+                }
+            }
+#endif
+            for (size_t i = 0; i < count; i++)
+                d_first[i] = ::std::move(first[i]);
+        }
+
       private:
         data_t _data;
         size_t _size{0};
@@ -764,11 +1101,13 @@ namespace containers {
         template <typename It, typename It2> constexpr plain_array_safe(It first, It last) {
             assign(first, last);
         }
-        constexpr plain_array_safe(const plain_array_safe &other) {
-            assign(other.begin(), other.end());
+        constexpr plain_array_safe(const plain_array_safe &other)
+            : _data{details::uninitialized_t{}}, _size{other._size} {
+            copy_values(other.data(), other._size, data());
         }
-        constexpr plain_array_safe(plain_array_safe &&other) noexcept {
-            assign(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+        constexpr plain_array_safe(plain_array_safe &&other) noexcept
+            : _data{details::uninitialized_t{}}, _size{other._size} {
+            move_values(other.data(), other._size, data());
         }
         constexpr plain_array_safe(::std::initializer_list<value_type> init) {
             assign(init.begin(), init.end());
@@ -838,14 +1177,16 @@ namespace containers {
         constexpr plain_array_safe &operator=(const plain_array_safe &other) {
             if (this == &other)
                 return *this;
-            plain_array_safe(other.begin(), other.end());
+            copy_values(other.data(), other._size, data());
+            _size = other._size;
             return *this;
         }
 
         constexpr plain_array_safe &operator=(plain_array_safe &&other) noexcept {
             if (this == &other)
                 return *this;
-            plain_array_safe(std::forward<plain_array_safe &&>(other));
+            move_values(other.data(), other._size, data());
+            _size = other._size;
             return *this;
         }
 
@@ -982,12 +1323,12 @@ namespace containers {
         // pop_front's (non-standard)
         constexpr void pop_front() {
             if (_size) {
-                copy(begin() + 1, end(), begin());
+                move(begin() + 1, end(), begin());
                 _size--;
             }
         }
         constexpr void unchecked_pop_front() {
-            copy(begin() + 1, end(), begin());
+            move(begin() + 1, end(), begin());
             _size--;
         }
 
@@ -995,7 +1336,7 @@ namespace containers {
             if (_size) {
                 size_t erase_idx = pos - cbegin();
                 if (erase_idx < _size) {
-                    copy(begin() + erase_idx + 1, end(), begin() + erase_idx);
+                    move(begin() + erase_idx + 1, end(), begin() + erase_idx);
                     _size--;
                     return begin() + erase_idx;
                 }
@@ -1019,7 +1360,7 @@ namespace containers {
                     iterator l = begin() + last_idx;
                     // a b c d - - - h i j k _ _ _ _
                     // a b c d h i j k _ _ _ _ _ _ _
-                    iterator c = copy(l, end(), f);
+                    iterator c = move(l, end(), f);
                     _size      = c - begin();
                     return begin() + erase_idx;
                 }
@@ -1042,7 +1383,7 @@ namespace containers {
                     return ret;
                 }
                 // move backwards
-                copy_backward(begin() + insert_idx, end(), end() + 1);
+                move_backward(begin() + insert_idx, end(), end() + 1);
                 // construct* inplace
                 data()[insert_idx] = value_type(std::forward<Args>(args)...);
                 _size += 1;
@@ -1080,7 +1421,7 @@ namespace containers {
                 }
                 size_t remaining    = N - _size;
                 size_t insert_count = count <= remaining ? count : remaining;
-                copy_backward(begin() + insert_idx, begin() + _size, begin() + (insert_count + _size));
+                move_backward(begin() + insert_idx, begin() + _size, begin() + (insert_count + _size));
                 fill(begin() + insert_idx, begin() + (insert_idx + insert_count), value);
                 _size += insert_count;
                 return ret;
@@ -1104,6 +1445,11 @@ namespace containers {
                     _size += insert_count;
                     return ret;
                 }
+#if __cpp_lib_is_constant_evaluated >= 201811L
+                // same result for a fraction of the constant evaluation steps
+                if (::std::is_constant_evaluated())
+                    return insert_backwards(pos, count, value);
+#endif
                 size_t remaining    = N - _size;
                 size_t insert_count = count <= remaining ? count : remaining;
 
@@ -1119,7 +1465,7 @@ namespace containers {
         }
 
         template <typename It, typename It2,
-                  typename std::enable_if<!std::is_convertible<It, size_type>::value>::type>
+                  typename = typename std::enable_if<!std::is_convertible<It, size_type>::value>::type>
         constexpr iterator insert(const_iterator pos, It first, It2 last) {
             if (_size < N) { //
                 size_t insert_idx = pos - cbegin();
@@ -1132,13 +1478,28 @@ namespace containers {
                         unchecked_emplace_back(*first);
                     return ret;
                 }
-                size_t mid_insert = _size;
-                for (; _size < N && first != last; ++first)
-                    unchecked_emplace_back(*first);
-                // size_t last_insert = _size;
-                // rotate algorithm
-                rotate(begin() + insert_idx, begin() + mid_insert, begin() + _size);
-                return ret;
+                if constexpr (::std::is_same<It, It2>::value &&
+                              ::std::is_base_of<::std::forward_iterator_tag,
+                                                typename ::std::iterator_traits<It>::iterator_category>::value) {
+                    // multi-pass ranges shift the tail once, a rotate moves every value about twice
+                    // (the difference dominates constant evaluation of large arrays)
+                    const size_t remaining    = N - _size;
+                    const size_t distance     = static_cast<size_t>(::std::distance(first, last));
+                    const size_t insert_count = distance <= remaining ? distance : remaining;
+                    move_backward(begin() + insert_idx, end(), end() + insert_count);
+                    for (size_t i = 0; i < insert_count; ++i, ++first)
+                        data()[insert_idx + i] = *first;
+                    _size += insert_count;
+                    return ret;
+                } else {
+                    size_t mid_insert = _size;
+                    for (; _size < N && first != last; ++first)
+                        unchecked_emplace_back(*first);
+                    // size_t last_insert = _size;
+                    // rotate algorithm
+                    rotate(begin() + insert_idx, begin() + mid_insert, begin() + _size);
+                    return ret;
+                }
             } else {
                 return end();
             }
@@ -1146,7 +1507,7 @@ namespace containers {
 
         // append (non-standard)
         template <typename It, typename It2,
-                  typename std::enable_if<
+                  typename = typename std::enable_if<
                       !std::is_same<typename std::iterator_traits<It>::value_type, void>::value>::type>
         constexpr iterator append(It first, It2 last) {
             if (_size < N) {
@@ -1179,9 +1540,676 @@ namespace containers {
             }
         }
 
+        // sort's (non-standard), small sizes are sorted by a sorting network fixed at compile time for N
+        constexpr void sort() {
+            sort(::std::less<value_type>{});
+        }
+        template <typename Compare> constexpr void sort(Compare comp) {
+            details::small_sort<N>(data(), _size, comp);
+        }
+
+        // partial_sort (non-standard), [begin(), middle) receive the smallest values in order
+        constexpr void partial_sort(const_iterator middle) {
+            partial_sort(middle, ::std::less<value_type>{});
+        }
+        template <typename Compare> constexpr void partial_sort(const_iterator middle, Compare comp) {
+            details::small_partial_sort<N>(data(), static_cast<size_t>(middle - cbegin()), _size, comp);
+        }
+
+        // nth_element (non-standard)
+        constexpr void nth_element(const_iterator nth) {
+            nth_element(nth, ::std::less<value_type>{});
+        }
+        template <typename Compare> constexpr void nth_element(const_iterator nth, Compare comp) {
+            details::small_nth_element<N>(data(), static_cast<size_t>(nth - cbegin()), _size, comp);
+        }
+
+        // only touches max(size(), other.size()) values
         constexpr void swap(plain_array_safe &other) noexcept(true) {
             if constexpr (N > 0) {
-                swap(_data._values, other._data._values);
+                if (this == &other)
+                    return;
+                plain_array_safe &longer  = _size < other._size ? other : *this;
+                plain_array_safe &shorter = _size < other._size ? *this : other;
+                value_type       *first1  = shorter.data();
+                value_type       *first2  = longer.data();
+                for (size_t i = 0; i < shorter._size; i++)
+                    swap(first1[i], first2[i]);
+                move_values(first2 + shorter._size, longer._size - shorter._size, first1 + shorter._size);
+                size_t tmp  = _size;
+                _size       = other._size;
+                other._size = tmp;
+            }
+        }
+    };
+    // circular_plain_array: plain_array with a head offset, storage wraps around so pop_front / push_front are O(1)
+    //  insert and erase shift whichever side of the position is shorter
+    //  linearize() rotates the storage (only when the values wrap) and returns a contiguous pointer
+    template <typename Ty, size_t N> struct circular_plain_array {
+      public:
+        using element_type    = Ty;
+        using value_type      = typename ::std::remove_cv<Ty>::type;
+        using const_reference = const value_type &;
+        using size_type       = ::std::size_t;
+        using difference_type = ::std::ptrdiff_t;
+        using pointer         = element_type *;
+        using const_pointer   = const value_type *;
+        using reference       = value_type &;
+
+        template <bool Const> struct basic_iterator {
+            using iterator_category = ::std::random_access_iterator_tag;
+            using difference_type   = ::std::ptrdiff_t;
+            using value_type        = typename ::std::remove_cv<Ty>::type;
+            using pointer           = typename ::std::conditional<Const, const value_type *, value_type *>::type;
+            using reference         = typename ::std::conditional<Const, const value_type &, value_type &>::type;
+            using container_pointer = typename ::std::conditional<Const, const circular_plain_array *,
+                                                                  circular_plain_array *>::type;
+
+            container_pointer _ptr = nullptr;
+            size_type         _idx = 0;
+
+            constexpr basic_iterator() noexcept = default;
+            constexpr basic_iterator(container_pointer ptr, size_type idx) noexcept : _ptr(ptr), _idx(idx) {
+            }
+            // iterator -> const_iterator
+            template <bool OtherConst, typename = typename ::std::enable_if<Const && !OtherConst>::type>
+            constexpr basic_iterator(const basic_iterator<OtherConst> &other) noexcept
+                : _ptr(other._ptr), _idx(other._idx) {
+            }
+
+            [[nodiscard]] constexpr reference operator*() const noexcept {
+                return _ptr->data()[_ptr->physical(_idx)];
+            }
+            [[nodiscard]] constexpr pointer operator->() const noexcept {
+                return _ptr->data() + _ptr->physical(_idx);
+            }
+            [[nodiscard]] constexpr reference operator[](difference_type n) const noexcept {
+                return _ptr->data()[_ptr->physical(_idx + n)];
+            }
+
+            constexpr basic_iterator &operator++() noexcept {
+                _idx++;
+                return *this;
+            }
+            constexpr basic_iterator operator++(int) noexcept {
+                basic_iterator tmp = *this;
+                _idx++;
+                return tmp;
+            }
+            constexpr basic_iterator &operator--() noexcept {
+                _idx--;
+                return *this;
+            }
+            constexpr basic_iterator operator--(int) noexcept {
+                basic_iterator tmp = *this;
+                _idx--;
+                return tmp;
+            }
+            constexpr basic_iterator &operator+=(difference_type n) noexcept {
+                _idx += n;
+                return *this;
+            }
+            constexpr basic_iterator &operator-=(difference_type n) noexcept {
+                _idx -= n;
+                return *this;
+            }
+            [[nodiscard]] friend constexpr basic_iterator operator+(basic_iterator it, difference_type n) noexcept {
+                return it += n;
+            }
+            [[nodiscard]] friend constexpr basic_iterator operator+(difference_type n, basic_iterator it) noexcept {
+                return it += n;
+            }
+            [[nodiscard]] friend constexpr basic_iterator operator-(basic_iterator it, difference_type n) noexcept {
+                return it -= n;
+            }
+            [[nodiscard]] friend constexpr difference_type operator-(const basic_iterator &a,
+                                                                     const basic_iterator &b) noexcept {
+                return static_cast<difference_type>(a._idx) - static_cast<difference_type>(b._idx);
+            }
+            friend constexpr bool operator==(const basic_iterator &a, const basic_iterator &b) noexcept {
+                return a._idx == b._idx;
+            }
+            friend constexpr bool operator!=(const basic_iterator &a, const basic_iterator &b) noexcept {
+                return a._idx != b._idx;
+            }
+            friend constexpr bool operator<(const basic_iterator &a, const basic_iterator &b) noexcept {
+                return a._idx < b._idx;
+            }
+            friend constexpr bool operator>(const basic_iterator &a, const basic_iterator &b) noexcept {
+                return a._idx > b._idx;
+            }
+            friend constexpr bool operator<=(const basic_iterator &a, const basic_iterator &b) noexcept {
+                return a._idx <= b._idx;
+            }
+            friend constexpr bool operator>=(const basic_iterator &a, const basic_iterator &b) noexcept {
+                return a._idx >= b._idx;
+            }
+        };
+
+        using iterator               = basic_iterator<false>;
+        using const_iterator         = basic_iterator<true>;
+        using reverse_iterator       = ::std::reverse_iterator<iterator>;
+        using const_reverse_iterator = ::std::reverse_iterator<const_iterator>;
+
+        struct storage {
+            value_type                  _values[N]{};
+            constexpr const value_type *data() const {
+                return _values;
+            }
+            constexpr value_type *data() {
+                return _values;
+            }
+        };
+
+        struct empty_storage {
+            constexpr const value_type *data() const {
+                return nullptr;
+            }
+            constexpr value_type *data() {
+                return nullptr;
+            }
+        };
+
+        using data_t = typename ::std::conditional<(N > 0), storage, empty_storage>::type;
+
+        static constexpr bool masked = N > 0 && !(N & (N - 1));
+
+        // maps idx in [0, 2N) onto [0, N)
+        static constexpr MUST_INLINE size_type wrap(size_type idx) noexcept {
+            if constexpr (masked) {
+                return idx & (N - 1);
+            } else {
+                return idx >= N ? idx - N : idx;
+            }
+        }
+
+        static constexpr MUST_INLINE void reverse(value_type *first, value_type *last) {
+#if __cplusplus_version > 201703L && __cpp_lib_constexpr_algorithms >= 201806L
+            ::std::reverse(first, last); // cross fingers this should be optimized
+#else
+            for (; first != last && first != --last; ++first) {
+                value_type tmp = *first;
+                *first         = *last;
+                *last          = tmp;
+            }
+#endif
+        }
+
+        static constexpr MUST_INLINE void rotate(value_type *first, value_type *mid, value_type *last) {
+#if __cplusplus_version > 201703L && __cpp_lib_constexpr_algorithms >= 201806L
+            ::std::rotate(first, mid, last); // cross fingers this should be optimized
+#else
+            reverse(first, mid);
+            reverse(mid, last);
+            reverse(first, last);
+#endif
+        }
+
+      private:
+        data_t _data;
+        size_t _head{0};
+        size_t _size{0};
+
+        // logical index -> index into _values
+        constexpr MUST_INLINE size_type physical(size_type pos) const noexcept {
+            return wrap(_head + pos);
+        }
+        constexpr MUST_INLINE reference at_logical(size_type pos) noexcept {
+            return data()[physical(pos)];
+        }
+
+        // opens a gap of count slots at logical idx by shifting whichever side is shorter
+        constexpr void open_gap(size_type idx, size_type count) {
+            if (!count)
+                return; // every move below would be a self move
+            if (idx < (_size - idx)) {
+                _head = wrap(_head + (N - count));
+                for (size_type i = 0; i < idx; i++)
+                    at_logical(i) = ::std::move(at_logical(i + count));
+            } else {
+                for (size_type i = _size; i > idx; i--)
+                    at_logical(i - 1 + count) = ::std::move(at_logical(i - 1));
+            }
+            _size += count;
+        }
+
+        // closes count slots at logical idx by shifting whichever side is shorter
+        constexpr void close_gap(size_type idx, size_type count) {
+            if (!count)
+                return;
+            if (idx < (_size - (idx + count))) {
+                for (size_type i = idx; i > 0; i--)
+                    at_logical(i - 1 + count) = ::std::move(at_logical(i - 1));
+                _head = wrap(_head + count);
+            } else {
+                for (size_type i = idx + count; i < _size; i++)
+                    at_logical(i - count) = ::std::move(at_logical(i));
+            }
+            _size -= count;
+        }
+
+      public:
+        constexpr circular_plain_array() noexcept : _head{0}, _size{0} {
+        }
+        constexpr circular_plain_array(size_type count, const value_type &value) {
+            assign(count, value);
+        }
+        constexpr explicit circular_plain_array(size_type count) {
+            assign(count);
+        }
+        template <typename It, typename It2> constexpr circular_plain_array(It first, It2 last) {
+            assign(first, last);
+        }
+        constexpr circular_plain_array(const circular_plain_array &other) {
+            assign(other.begin(), other.end());
+        }
+        constexpr circular_plain_array(circular_plain_array &&other) noexcept {
+            assign(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+        }
+        constexpr circular_plain_array(::std::initializer_list<value_type> init) {
+            assign(init.begin(), init.end());
+        }
+
+        constexpr circular_plain_array &operator=(const circular_plain_array &other) {
+            if (this == &other)
+                return *this;
+            assign(other.begin(), other.end());
+            return *this;
+        }
+
+        constexpr circular_plain_array &operator=(circular_plain_array &&other) noexcept {
+            if (this == &other)
+                return *this;
+            assign(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+            return *this;
+        }
+
+        constexpr void assign(size_type count, const value_type &value) {
+            const size_t mx = count >= N ? N : count;
+            _head           = 0;
+            _size           = mx;
+            for (size_t i = 0; i < mx; i++)
+                data()[i] = value;
+        }
+
+        constexpr void assign(size_type count) {
+            const size_t mx = count >= N ? N : count;
+            _head           = 0;
+            _size           = mx;
+            for (size_t i = 0; i < mx; i++)
+                data()[i] = value_type();
+        }
+
+        template <typename It, typename It2> constexpr void assign(It first, It2 last) {
+            _head = 0;
+            _size = 0;
+            for (; _size < N && first != last; ++first) {
+                data()[_size] = *first;
+                _size++;
+            }
+        }
+
+        //[]'s
+        [[nodiscard]] constexpr reference operator[](size_type pos) {
+            assert(pos < _size);
+            return data()[physical(pos)];
+        };
+        [[nodiscard]] constexpr const_reference operator[](size_type pos) const {
+            assert(pos < _size);
+            return data()[physical(pos)];
+        };
+        // front
+        [[nodiscard]] constexpr reference front() {
+            assert(_size > 0);
+            return data()[_head];
+        };
+        [[nodiscard]] constexpr const_reference front() const {
+            assert(_size > 0);
+            return data()[_head];
+        };
+        // back's
+        [[nodiscard]] constexpr reference back() {
+            assert(_size > 0);
+            return data()[physical(_size - 1)];
+        };
+        [[nodiscard]] constexpr const_reference back() const {
+            assert(_size > 0);
+            return data()[physical(_size - 1)];
+        };
+
+        // data's, note: the values start at data() + head() and may wrap, see linearize()
+        [[nodiscard]] constexpr value_type *data() noexcept {
+            return _data.data();
+        };
+        [[nodiscard]] constexpr const value_type *data() const noexcept {
+            return _data.data();
+        };
+        // head (non-standard)
+        [[nodiscard]] constexpr size_type head() const noexcept {
+            return _head;
+        }
+        // is_linearized (non-standard)
+        [[nodiscard]] constexpr bool is_linearized() const noexcept {
+            return (_head + _size) <= N;
+        }
+        // linearize (non-standard), returns a pointer to size() contiguous values
+        constexpr value_type *linearize() {
+            if (!is_linearized()) {
+                rotate(data(), data() + _head, data() + N);
+                _head = 0;
+            }
+            return data() + _head;
+        }
+
+        // begin's
+        [[nodiscard]] constexpr iterator begin() noexcept {
+            return iterator(this, 0);
+        };
+        [[nodiscard]] constexpr const_iterator begin() const noexcept {
+            return const_iterator(this, 0);
+        };
+        [[nodiscard]] constexpr const_iterator cbegin() const noexcept {
+            return const_iterator(this, 0);
+        };
+        // rbegin's
+        [[nodiscard]] constexpr reverse_iterator rbegin() noexcept {
+            return reverse_iterator(end());
+        };
+        [[nodiscard]] constexpr const_reverse_iterator rbegin() const noexcept {
+            return const_reverse_iterator(end());
+        };
+        [[nodiscard]] constexpr const_reverse_iterator crbegin() const noexcept {
+            return const_reverse_iterator(end());
+        };
+        // end's
+        [[nodiscard]] constexpr iterator end() noexcept {
+            return iterator(this, _size);
+        };
+        [[nodiscard]] constexpr const_iterator end() const noexcept {
+            return const_iterator(this, _size);
+        };
+        [[nodiscard]] constexpr const_iterator cend() const noexcept {
+            return const_iterator(this, _size);
+        };
+        // rend's
+        [[nodiscard]] constexpr reverse_iterator rend() noexcept {
+            return reverse_iterator(begin());
+        };
+        [[nodiscard]] constexpr const_reverse_iterator rend() const noexcept {
+            return const_reverse_iterator(begin());
+        };
+        [[nodiscard]] constexpr const_reverse_iterator crend() const noexcept {
+            return const_reverse_iterator(begin());
+        };
+
+        template <typename... Args> constexpr reference emplace_back(Args &&...args) {
+            if (_size < N) {
+                return unchecked_emplace_back(std::forward<Args>(args)...);
+            } else {
+                return back();
+            }
+        }
+
+        // writes data to last index without checking on the size, quick but unsafe
+        template <typename... Args> constexpr reference unchecked_emplace_back(Args &&...args) {
+            size_t idx  = physical(_size);
+            data()[idx] = value_type(std::forward<Args>(args)...);
+            _size++;
+            return data()[idx];
+        }
+
+        // emplace_front's (non-standard)
+        template <typename... Args> constexpr reference emplace_front(Args &&...args) {
+            if (_size < N) {
+                return unchecked_emplace_front(std::forward<Args>(args)...);
+            } else {
+                return front();
+            }
+        }
+
+        template <typename... Args> constexpr reference unchecked_emplace_front(Args &&...args) {
+            size_t idx  = wrap(_head + (N - 1));
+            data()[idx] = value_type(std::forward<Args>(args)...);
+            _head       = idx;
+            _size++;
+            return data()[idx];
+        }
+
+        // push_back's
+        constexpr void push_back(const value_type &value) {
+            emplace_back(::std::forward<const value_type &>(value));
+        }
+
+        constexpr void push_back(value_type &&value) {
+            emplace_back(::std::forward<value_type &&>(value));
+        };
+
+        constexpr void unchecked_push_back(const value_type &value) {
+            unchecked_emplace_back(::std::forward<const value_type &>(value));
+        }
+
+        constexpr void unchecked_push_back(value_type &&value) {
+            unchecked_emplace_back(::std::forward<value_type &&>(value));
+        }
+
+        // push_front's (non-standard)
+        constexpr void push_front(const value_type &value) {
+            emplace_front(::std::forward<const value_type &>(value));
+        }
+
+        constexpr void push_front(value_type &&value) {
+            emplace_front(::std::forward<value_type &&>(value));
+        };
+
+        // pop_back's
+        constexpr void pop_back() {
+            if (_size) {
+                _size--;
+            }
+        }
+        constexpr void unchecked_pop_back() {
+            _size--;
+        }
+
+        // pop_front's (non-standard), O(1)
+        constexpr void pop_front() {
+            if (_size) {
+                _head = wrap(_head + 1);
+                _size--;
+            }
+        }
+        constexpr void unchecked_pop_front() {
+            _head = wrap(_head + 1);
+            _size--;
+        }
+
+        // clear
+        constexpr void clear() {
+            _head = 0;
+            _size = 0;
+        }
+
+        // empty
+        constexpr bool empty() {
+            return _size == 0;
+        }
+        constexpr bool empty() const {
+            return _size == 0;
+        }
+        // full (non-standard)
+        constexpr bool full() const {
+            return _size == N;
+        }
+
+        // capacity
+        constexpr size_t capacity() {
+            return N;
+        }
+        constexpr size_t capacity() const {
+            return N;
+        }
+        // max_size
+        constexpr size_t max_size() {
+            return N;
+        }
+        constexpr size_t max_size() const {
+            return N;
+        }
+        // size
+        constexpr size_t size() {
+            return _size;
+        }
+        constexpr size_t size() const {
+            return _size;
+        }
+
+        constexpr iterator erase(const_iterator pos) {
+            if (_size) {
+                size_t erase_idx = pos - cbegin();
+                if (erase_idx < _size) {
+                    close_gap(erase_idx, 1);
+                    return begin() + erase_idx;
+                }
+                return end();
+            } else {
+                return end();
+            }
+        }
+
+        constexpr iterator erase(const_iterator first, const_iterator last) {
+            if (first == last) {
+                size_t erase_idx = last - cbegin();
+                return begin() + erase_idx;
+            }
+            if (_size) {
+                size_t erase_idx = first - cbegin();
+                size_t last_idx  = last - cbegin();
+                if (erase_idx < last_idx && erase_idx < _size && last_idx <= _size) {
+                    close_gap(erase_idx, last_idx - erase_idx);
+                    return begin() + erase_idx;
+                }
+                return end();
+            } else {
+                return end();
+            }
+        }
+
+        // emplace
+        template <typename... Args> constexpr iterator emplace(const_iterator pos, Args &&...args) {
+            if (_size < N) {
+                size_t insert_idx = pos - cbegin();
+                // clamp insertion point
+                insert_idx = insert_idx <= _size ? insert_idx : _size;
+                if (insert_idx == _size) {
+                    unchecked_emplace_back(std::forward<Args>(args)...);
+                    return begin() + insert_idx;
+                }
+                value_type value(std::forward<Args>(args)...);
+                open_gap(insert_idx, 1);
+                at_logical(insert_idx) = ::std::move(value);
+                return begin() + insert_idx;
+            } else {
+                return end();
+            }
+        };
+
+        // insert
+        constexpr iterator insert(const_iterator pos, const value_type &value) {
+            return emplace(pos, value);
+        };
+        constexpr iterator insert(const_iterator pos, value_type &&value) {
+            return emplace(pos, ::std::move(value));
+        };
+        constexpr iterator insert(const_iterator pos, size_type count, const value_type &value) {
+            if (_size < N) {
+                size_t insert_idx = pos - cbegin();
+                // clamp insertion point
+                insert_idx          = insert_idx <= _size ? insert_idx : _size;
+                size_t remaining    = N - _size;
+                size_t insert_count = count <= remaining ? count : remaining;
+                if (!insert_count)
+                    return begin() + insert_idx;
+                const value_type copy = value; // value may live inside this array, open_gap moves it
+                open_gap(insert_idx, insert_count);
+                for (size_t i = 0; i < insert_count; i++)
+                    at_logical(insert_idx + i) = copy;
+                return begin() + insert_idx;
+            } else {
+                return end();
+            }
+        }
+
+        template <typename It, typename It2,
+                  typename = typename std::enable_if<!std::is_convertible<It, size_type>::value>::type>
+        constexpr iterator insert(const_iterator pos, It first, It2 last) {
+            if (_size < N) {
+                size_t insert_idx = pos - cbegin();
+                // clamp insertion point
+                insert_idx        = insert_idx <= _size ? insert_idx : _size;
+                if (first == last)
+                    return begin() + insert_idx;
+                size_t mid_insert = _size;
+                for (; _size < N && first != last; ++first)
+                    unchecked_emplace_back(*first);
+                // rotate the appended values into place
+                if (insert_idx != mid_insert)
+                    ::std::rotate(begin() + insert_idx, begin() + mid_insert, end());
+                return begin() + insert_idx;
+            } else {
+                return end();
+            }
+        }
+
+        // append (non-standard)
+        template <typename It, typename It2,
+                  typename = typename std::enable_if<!std::is_convertible<It, size_type>::value>::type>
+        constexpr iterator append(It first, It2 last) {
+            if (_size < N) {
+                const size_t idx = _size;
+                for (; _size < N && first != last; ++first)
+                    unchecked_emplace_back(*first);
+                return begin() + idx;
+            } else {
+                return end();
+            }
+        }
+        constexpr iterator append(size_t count, const value_type &value) {
+            if (_size < N) {
+                const size_t idx = _size;
+                for (size_t i = 0; _size < N && i < count; i++)
+                    unchecked_emplace_back(value);
+                return begin() + idx;
+            } else {
+                return end();
+            }
+        }
+        constexpr iterator append(size_t count) {
+            if (_size < N) {
+                const size_t idx = _size;
+                for (size_t i = 0; _size < N && i < count; i++)
+                    unchecked_emplace_back();
+                return begin() + idx;
+            } else {
+                return end();
+            }
+        }
+
+        // only touches max(size(), other.size()) values
+        constexpr void swap(circular_plain_array &other) noexcept(true) {
+            if constexpr (N > 0) {
+                if (this == &other)
+                    return;
+                // each side keeps its own head, values are exchanged by logical index
+                circular_plain_array &longer  = _size < other._size ? other : *this;
+                circular_plain_array &shorter = _size < other._size ? *this : other;
+                size_t                i       = 0;
+                for (; i < shorter._size; i++) {
+                    value_type tmp        = ::std::move(shorter.at_logical(i));
+                    shorter.at_logical(i) = ::std::move(longer.at_logical(i));
+                    longer.at_logical(i)  = ::std::move(tmp);
+                }
+                for (; i < longer._size; i++)
+                    shorter.at_logical(i) = ::std::move(longer.at_logical(i));
                 size_t tmp  = _size;
                 _size       = other._size;
                 other._size = tmp;
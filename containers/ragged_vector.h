@@ -0,0 +1,255 @@
+#pragma once
+#include "real_vector.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2021 Alex Anderson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// ragged_vector<T>: rows of different lengths in compressed sparse row form, every value of every row in one
+//  real::vector<T> and rows() + 1 offsets into it, row r is values [offsets[r], offsets[r + 1])
+//  two allocations in total instead of one per row, no per row header, rows are adjacent in memory so a
+//  traversal streams through values
+//  rows are appended at the end (append_row), only the last row can grow (append_to_last_row)
+//  from_pairs() builds the whole structure from unordered (row, value) pairs with a counting sort, two passes
+//  and no per row allocation, values keep the order they had within each row
+//  parallel_for_each_row() splits the rows over threads at offsets, so each thread gets about as many values
+//  (not rows) to visit
+//
+//	real::ragged_vector<uint32_t> graph = real::ragged_vector<uint32_t>::from_pairs(node_count, edges);
+//	for (uint32_t next : graph[node])
+//		...
+
+namespace real {
+	template <typename T, typename Allocator = ::std::allocator<T>> class ragged_vector {
+	  public:
+		using value_type     = T;
+		using size_type      = ::std::size_t;
+		using allocator_type = Allocator;
+		using row_type       = ::std::span<T>;
+		using const_row_type = ::std::span<const T>;
+
+	  private:
+		using offset_allocator = typename ::std::allocator_traits<Allocator>::template rebind_alloc<size_type>;
+
+		vector<T, Allocator>                _values;
+		vector<size_type, offset_allocator> _offsets; // empty, or rows() + 1 entries starting at 0
+
+		void _close_row() {
+			if (_offsets.empty())
+				_offsets.push_back(0);
+			_offsets.push_back(_values.size());
+		}
+
+	  public:
+		ragged_vector() = default;
+		explicit ragged_vector(const Allocator &alloc) : _values(alloc), _offsets(offset_allocator(alloc)) {
+		}
+
+		// rows
+		[[nodiscard]] size_type rows() const noexcept {
+			return _offsets.empty() ? 0 : _offsets.size() - 1;
+		}
+		[[nodiscard]] bool empty() const noexcept {
+			return rows() == 0;
+		}
+		// values across all rows
+		[[nodiscard]] size_type size() const noexcept {
+			return _values.size();
+		}
+		[[nodiscard]] size_type row_size(size_type r) const noexcept {
+			assert(r < rows());
+			return _offsets[r + 1] - _offsets[r];
+		}
+
+		[[nodiscard]] row_type operator[](size_type r) noexcept {
+			assert(r < rows());
+			return row_type(_values.data() + _offsets[r], _offsets[r + 1] - _offsets[r]);
+		}
+		[[nodiscard]] const_row_type operator[](size_type r) const noexcept {
+			assert(r < rows());
+			return const_row_type(_values.data() + _offsets[r], _offsets[r + 1] - _offsets[r]);
+		}
+		[[nodiscard]] row_type row(size_type r) {
+			if (!(r < rows()))
+				throw ::std::out_of_range("accessing row out of range of ragged_vector");
+			return operator[](r);
+		}
+		[[nodiscard]] const_row_type row(size_type r) const {
+			if (!(r < rows()))
+				throw ::std::out_of_range("accessing row out of range of ragged_vector");
+			return operator[](r);
+		}
+
+		// the flat arrays
+		[[nodiscard]] ::std::span<T> values() noexcept {
+			return {_values.data(), _values.size()};
+		}
+		[[nodiscard]] ::std::span<const T> values() const noexcept {
+			return {_values.data(), _values.size()};
+		}
+		[[nodiscard]] ::std::span<const size_type> offsets() const noexcept {
+			return {_offsets.data(), _offsets.size()};
+		}
+
+		void reserve(size_type row_count, size_type value_count) {
+			_offsets.reserve(row_count + 1);
+			_values.reserve(value_count);
+		}
+
+		void clear() noexcept {
+			_values.clear();
+			_offsets.clear();
+		}
+
+		// append_row's, returning the new row
+		//  a contiguous range may be one of this vector's rows (g.append_row(g[r]) duplicates row r), other ranges
+		//  must not refer into values(), growth would free them mid copy
+		template <::std::ranges::input_range Range> row_type append_row(Range &&range) {
+			if constexpr (::std::ranges::contiguous_range<Range> && ::std::ranges::sized_range<Range> &&
+			              ::std::is_same_v<::std::remove_cv_t<::std::ranges::range_value_t<Range>>, T>) {
+				const T        *first = ::std::ranges::data(range);
+				const size_type count = static_cast<size_type>(::std::ranges::size(range));
+				// compared as addresses, first need not point into values()
+				const ::std::uintptr_t address = reinterpret_cast<::std::uintptr_t>(first);
+				const ::std::uintptr_t begin   = reinterpret_cast<::std::uintptr_t>(_values.data());
+				if (count && address >= begin && address < begin + _values.size() * sizeof(T)) {
+					// reserve first, then find the row again in the (possibly moved) values
+					const size_type offset = (address - begin) / sizeof(T);
+					if (_values.capacity() - _values.size() < count)
+						_values.reserve(geometric_int_expansion_policy<2>{}.grow_capacity(
+							_values.size(), _values.capacity(), _values.size() + count));
+					_values.insert(_values.end(), _values.data() + offset, _values.data() + offset + count);
+					_close_row();
+					return operator[](rows() - 1);
+				}
+			}
+			if constexpr (::std::ranges::common_range<Range>) {
+				_values.insert(_values.end(), ::std::ranges::begin(range), ::std::ranges::end(range));
+			} else {
+				for (auto &&value : range)
+					_values.emplace_back(::std::forward<decltype(value)>(value));
+			}
+			_close_row();
+			return operator[](rows() - 1);
+		}
+		row_type append_row(::std::initializer_list<T> ilist) {
+			return append_row(::std::span<const T>(ilist.begin(), ilist.size()));
+		}
+		// an empty row
+		row_type append_row() {
+			_close_row();
+			return operator[](rows() - 1);
+		}
+
+		// grows the last row by one value
+		template <typename... Args> T &append_to_last_row(Args &&...args) {
+			assert(!empty() && "append_to_last_row without a row");
+			T &value = _values.emplace_back(::std::forward<Args>(args)...);
+			_offsets.back() += 1;
+			return value;
+		}
+
+		// rows [0, row_count) from (row, value) pairs in any order, T must be default constructible
+		//  throws std::out_of_range for a row past row_count
+		template <typename Pairs>
+		[[nodiscard]] static ragged_vector from_pairs(size_type row_count, const Pairs &pairs,
+		                                              const Allocator &alloc = Allocator()) {
+			ragged_vector result(alloc);
+			result._offsets.assign(row_count + 1, size_type{0});
+			// counts land one slot up so the prefix sum below leaves each row's start in place
+			for (const auto &[r, value] : pairs) {
+				if (!(static_cast<size_type>(r) < row_count))
+					throw ::std::out_of_range("ragged_vector::from_pairs row out of range");
+				result._offsets[static_cast<size_type>(r) + 1] += 1;
+			}
+			for (size_type r = 0; r < row_count; r++)
+				result._offsets[r + 1] += result._offsets[r];
+
+			result._values.assign(result._offsets[row_count], T());
+			vector<size_type, offset_allocator> cursor{offset_allocator(alloc)}; // next free slot of each row
+			cursor.assign(result._offsets.begin(), result._offsets.end() - 1);
+			for (const auto &[r, value] : pairs)
+				result._values[cursor[static_cast<size_type>(r)]++] = value;
+			return result;
+		}
+
+		// fn(r, row) for every row, spread over thread_count threads (the calling thread is one of them)
+		//  rows are split so every thread visits about size() / thread_count values, the first exception
+		//  thrown by fn is rethrown after every thread has finished
+		template <typename Fn>
+		void parallel_for_each_row(Fn &&fn, unsigned thread_count = ::std::thread::hardware_concurrency()) const {
+			const size_type row_count = rows();
+			if (!row_count)
+				return;
+			thread_count = thread_count ? thread_count : 1;
+			if (thread_count > row_count)
+				thread_count = static_cast<unsigned>(row_count);
+
+			// thread t takes rows [bounds[t], bounds[t + 1]), cut where the offsets pass t / thread_count of the values
+			::std::vector<size_type> bounds(thread_count + 1, row_count);
+			bounds[0] = 0;
+			for (unsigned t = 1; t < thread_count; t++) {
+				const size_type target = size() / thread_count * t;
+				const size_type *cut   = ::std::lower_bound(_offsets.begin() + bounds[t - 1], _offsets.end() - 1, target);
+				bounds[t]              = static_cast<size_type>(cut - _offsets.begin());
+			}
+
+			::std::exception_ptr error;
+			::std::mutex         error_mutex;
+			const auto           visit = [&](unsigned t) {
+				try {
+					for (size_type r = bounds[t]; r < bounds[t + 1]; r++)
+						fn(r, operator[](r));
+				} catch (...) {
+					::std::lock_guard<::std::mutex> lock(error_mutex);
+					if (!error)
+						error = ::std::current_exception();
+				}
+			};
+			::std::vector<::std::thread> workers;
+			workers.reserve(thread_count - 1);
+			for (unsigned t = 1; t < thread_count; t++)
+				workers.emplace_back(visit, t);
+			visit(0);
+			for (::std::thread &worker : workers)
+				worker.join();
+			if (error)
+				::std::rethrow_exception(error);
+		}
+	};
+} // namespace real
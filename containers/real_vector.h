@@ -1,4 +1,5 @@
 #pragma once
+#include "bit_words.h"
 #include <cstdint>
 #include <initializer_list>
 #include <iterator>
@@ -8,6 +9,7 @@
 #include <cassert>
 #include <utility>
 #include <memory_resource>
+#include <bit>
 
 /*
 The MIT License (MIT)
@@ -50,9 +52,9 @@ namespace real {
 		template <typename Iterator>
 		constexpr void destroy(Iterator first, Iterator last) {
 			using iterator_traits = std::iterator_traits<Iterator>;
-			if constexpr (!std::is_trivially_destructible_v<iterator_traits::value_type>) {
+			if constexpr (!std::is_trivially_destructible_v<typename iterator_traits::value_type>) {
 				for (; first != last; ++first)
-					destroy_at(::std::addressof(*first));
+					details::destroy_at(::std::addressof(*first));
 			}
 		}
 
@@ -71,7 +73,7 @@ namespace real {
 		}
 
 		template <typename Alloc>
-		constexpr void pocca(Alloc &left, Alloc &right) noexcept {
+		constexpr void pocca(Alloc &left, const Alloc &right) noexcept {
 			if constexpr (::std::allocator_traits<Alloc>::propagate_on_container_copy_assignment::value) {
 				left = right;
 			}
@@ -87,6 +89,40 @@ namespace real {
 			return ::std::allocator_traits<Alloc>::propagate_on_container_copy_assignment::value;
 		}
 
+		// allocators with static constexpr bool releases_in_bulk = true hand out memory their resource frees all at
+		//  once (an arena), so vectors of trivially destructible values have nothing to do on teardown
+		template <typename Alloc>
+		constexpr bool releases_in_bulk() noexcept {
+			if constexpr (requires { Alloc::releases_in_bulk; })
+				return Alloc::releases_in_bulk;
+			else
+				return false;
+		}
+
+		// alloc.allocate_at_least(count) when the allocator has it (C++23's extension point, an allocator that rounds
+		//  requests up reports the real size), otherwise allocate(count), the vector keeps the count as its capacity
+		//  and hands the same count back to deallocate
+		template <typename Alloc>
+		constexpr auto allocate_at_least(Alloc &alloc, size_t count) {
+			using pointer = typename ::std::allocator_traits<Alloc>::pointer;
+			if constexpr (requires { alloc.allocate_at_least(count); }) {
+				auto result = alloc.allocate_at_least(count);
+				return allocation_result<pointer>{result.ptr, result.count};
+			} else {
+				return allocation_result<pointer>{alloc.allocate(count), count};
+			}
+		}
+
+		// the count allocate_at_least(count) would return, from alloc.allocation_size(count) when the allocator rounds
+		//  requests up, lets shrink_to_fit tell a buffer that is already as small as it gets
+		template <typename Alloc>
+		constexpr size_t allocation_size(const Alloc &alloc, size_t count) noexcept {
+			if constexpr (requires { alloc.allocation_size(count); })
+				return alloc.allocation_size(count);
+			else
+				return count;
+		}
+
 		template <typename T, bool> struct dependent_type : public T {};
 
 		//can optimize Ty1 away (empty base class optimization)
@@ -220,8 +256,27 @@ namespace real {
 		}
 	};
 
+	// instrumentation policy: static hooks real::vector calls as it grows, inserts and erases
+	//  positions are indices before the operation, an insert at new_size - count is at the back
+	//  on_reserve is an explicit reserve() call, growth from inserts only reports on_grow
+	//  the default compiles to nothing, see vector_instrumentation.h for thread-local counters
+	//  and vector_trace.h for recording replayable traces
+	struct no_instrumentation {
+		static constexpr void on_grow(size_t /*old_capacity*/, size_t /*new_capacity*/, size_t /*bytes_relocated*/) noexcept {
+		}
+		static constexpr void on_shrink(size_t /*old_capacity*/, size_t /*new_capacity*/, size_t /*bytes_relocated*/) noexcept {
+		}
+		static constexpr void on_reserve(size_t /*requested_capacity*/) noexcept {
+		}
+		static constexpr void on_insert(size_t /*pos*/, size_t /*count*/, size_t /*new_size*/) noexcept {
+		}
+		static constexpr void on_erase(size_t /*pos*/, size_t /*count*/, size_t /*new_size*/) noexcept {
+		}
+	};
+
 	template <typename T,
-		typename Allocator = std::allocator<T>
+		typename Allocator = std::allocator<T>,
+		typename Instrumentation = no_instrumentation
 	> class vector {
 	  public:
 		
@@ -238,11 +293,14 @@ namespace real {
 		using reverse_iterator       = ::std::reverse_iterator<iterator>;
 		using const_reverse_iterator = ::std::reverse_iterator<const_iterator>;
 		using allocator_type         = Allocator;
+		using instrumentation_type   = Instrumentation;
+		// what the allocator hands out, stored as is (an offset_ptr for shm_allocator), iterators stay raw pointers
+		using allocator_pointer = typename ::std::allocator_traits<allocator_type>::pointer;
 
 		using rebind_allocator_type = typename ::std::allocator_traits<allocator_type>::template rebind_alloc<value_type>;
 	  private: //data members
-		T *       _begin    = {};
-		T *       _end      = {};
+		allocator_pointer _begin = {};
+		allocator_pointer _end   = {};
 		/* LLVM and MSVC make these a "compressed_pair"
 		size_t    _capacity = {};
 		//because we don't need this as a member (but it could have members of its own)
@@ -250,10 +308,39 @@ namespace real {
 		*/
 		details::compressed_pair<Allocator, size_t> _capacity_allocator;
 	  private:
+		// hooks are skipped in constant evaluation, counters are runtime state
+		constexpr void _record_reallocation(size_type old_capacity, size_type new_capacity, size_type moved) noexcept {
+			if (!::std::is_constant_evaluated()) {
+				if (new_capacity < old_capacity)
+					Instrumentation::on_shrink(old_capacity, new_capacity, moved * sizeof(T));
+				else
+					Instrumentation::on_grow(old_capacity, new_capacity, moved * sizeof(T));
+			}
+		}
+		constexpr void _record_reserve(size_type requested_capacity) noexcept {
+			if (!::std::is_constant_evaluated())
+				Instrumentation::on_reserve(requested_capacity);
+		}
+		constexpr void _record_insert(size_type pos, size_type count) noexcept {
+			if (!::std::is_constant_evaluated())
+				Instrumentation::on_insert(pos, count, size());
+		}
+		constexpr void _record_erase(size_type pos, size_type count) noexcept {
+			if (!::std::is_constant_evaluated())
+				Instrumentation::on_erase(pos, count, size());
+		}
+
 		constexpr void _cleanup() noexcept {
+			if constexpr (details::releases_in_bulk<Allocator>() && ::std::is_trivially_destructible<T>::value) {
+				// the arena takes the buffer back on release(), forgetting it is enough
+				_begin                       = nullptr;
+				_end                         = nullptr;
+				_capacity_allocator.second() = 0ULL;
+				return;
+			}
 			//orphan iterators?
 			if (_begin) {
-				details::destroy(_begin, _end);
+				details::destroy(::std::to_address(_begin), ::std::to_address(_end));
 				get_allocator().deallocate(_begin, capacity());
 				_begin = nullptr;
 				_end   = nullptr;
@@ -270,40 +357,44 @@ namespace real {
 		template <typename Iterator, typename ExpansionPolicy>
 		constexpr iterator insert_range(const_iterator pos, Iterator first, Iterator last, ExpansionPolicy) {
 			size_type insert_idx = pos - cbegin();
-			iterator  ret_it     = begin() + insert_idx;
-			
+
 			// insert input range [first, last) at _Where
 			if (first == last) {
-				return ret_it; //nothing to do
+				return begin() + insert_idx; //nothing to do
 			}
 
 			assert(pos >= cbegin() && pos <= cend() && "insert iterator is out of bounds");
 			const size_type old_size = size();
 
 			if constexpr (::std::is_same<::std::random_access_iterator_tag,
-			                             ::std::iterator_traits<Iterator>::iterator_category>::value) {
+			                             typename ::std::iterator_traits<Iterator>::iterator_category>::value) {
 				size_type insert_count = last - first;
 				if (!can_store(insert_count)) {
 					size_t target_capacity = ExpansionPolicy{}.grow_capacity(
 						old_size, _capacity_allocator.second(), _capacity_allocator.second() + insert_count);
-					reserve(target_capacity);
+					_reallocate(target_capacity);
 				}
 				// already safe from check above*
 				::std::uninitialized_copy(first, last, end());
 				_end += insert_count;
 				//_size += insert_count;
 			} else {
-				// bounds check each emplace_back, saturating
-				for (; first != last && size() < capacity(); ++first) {
-					unchecked_emplace_back(*first);
-				}
+				// bounds check each append, growing with the policy (recorded once below, not per value)
 				for (; first != last; ++first) {
-					emplace_back(*first);
+					if (full()) {
+						_reallocate(ExpansionPolicy{}.grow_capacity(size(), _capacity_allocator.second(),
+						                                            _capacity_allocator.second() + 1));
+					}
+					::std::allocator_traits<allocator_type>::construct(_capacity_allocator.first(),
+					                                                   ::std::to_address(_end), *first);
+					_end += 1;
 				}
 			}
+			_record_insert(insert_idx, size() - old_size);
 
+			// growing invalidates pos, only the index is kept
 			::std::rotate(begin() + insert_idx, begin() + old_size, end());
-			return ret_it;
+			return begin() + insert_idx;
 		}
 
 	  public:
@@ -325,7 +416,7 @@ namespace real {
 			: _capacity_allocator(details::zero_then_variadic_args_t{}) {
 			if (count) {
 				cleared_reserve(count);
-				::std::uninitialized_fill(_begin, _begin + count, value);
+				::std::uninitialized_fill(data(), data() + count, value);
 				_end = _begin + count;
 			}
 		}
@@ -334,7 +425,7 @@ namespace real {
 			: _capacity_allocator(details::one_then_variadic_args_t{}, alloc) {
 			if (count) {
 				cleared_reserve(count);
-				::std::uninitialized_fill(_begin, _begin + count, value);
+				::std::uninitialized_fill(data(), data() + count, value);
 				_end = _begin + count;
 			}
 		}
@@ -344,7 +435,7 @@ namespace real {
 			size_type count = std::distance(first, last);
 			if (count) {
 				cleared_reserve(count);
-				::std::uninitialized_copy(first, last, _begin);
+				::std::uninitialized_copy(first, last, data());
 				_end = _begin + count;
 			}
 		}
@@ -356,7 +447,7 @@ namespace real {
 			size_t count = other.size();
 			if (count) {
 				cleared_reserve(count);
-				::std::uninitialized_copy(other.begin(), other.end(), _begin);
+				::std::uninitialized_copy(other.begin(), other.end(), data());
 				_end = _begin + count;
 			}
 		}
@@ -366,39 +457,42 @@ namespace real {
 				this->operator=(other);
 		}
 
-		constexpr vector(vector &&other) : _capacity_allocator(details::zero_then_variadic_args_t{}) {
-			if (!other.empty())
-				this->operator=(::std::move(other));
+		// takes other's buffer and a copy of its allocator (which need not be default constructible)
+		constexpr vector(vector &&other) noexcept
+			: _capacity_allocator(details::one_then_variadic_args_t{}, other._capacity_allocator.first()) {
+			_begin                       = ::std::exchange(other._begin, nullptr);
+			_end                         = ::std::exchange(other._end, nullptr);
+			_capacity_allocator.second() = ::std::exchange(other._capacity_allocator.second(), 0);
 		}
 		
 		constexpr void set_vector(const pointer data, const size_type new_size, const size_type new_capacity) {
-			T *    old_begin         = _begin;
-			T *    old_end           = _end;
+			T *    old_begin         = ::std::to_address(_begin);
+			T *    old_end           = ::std::to_address(_end);
 			size_t old_capacity      = _capacity_allocator.second();
 			size_t required_capacity = std::max(new_size, new_capacity);
 
 			if (_begin) {
 				details::destroy(old_begin, old_end);
-				get_allocator().deallocate(_begin, static_cast<size_type>(_end - _begin));
+				get_allocator().deallocate(_begin, old_capacity);
 			}
 
-			_begin    = data;
-			_end      = data + new_size;
+			_begin    = allocator_pointer(data);
+			_end      = _begin + new_size;
 			_capacity_allocator.second() = required_capacity;
 		}
 		// note: like shrink_to_fit
 		constexpr void unchecked_reserve(size_type new_capacity) {
-			T *    old_begin         = _begin;
-			T *    old_end           = _end;
+			T *    old_begin         = ::std::to_address(_begin);
+			T *    old_end           = ::std::to_address(_end);
 			size_t old_size          = static_cast<size_type>(old_end - old_begin);
 			size_t old_capacity      = _capacity_allocator.second();
-			size_t required_capacity = std::max(old_size, new_capacity);
-
-			const pointer newdata = get_allocator().allocate(required_capacity);
+			const auto [newdata, required_capacity] =
+				details::allocate_at_least(_capacity_allocator.first(), std::max(old_size, new_capacity));
 		
 			try {
 				//move data over
-				::std::uninitialized_copy(::std::make_move_iterator(old_begin), ::std::make_move_iterator(old_end), newdata);
+				::std::uninitialized_copy(::std::make_move_iterator(old_begin), ::std::make_move_iterator(old_end),
+				                          ::std::to_address(newdata));
 			} catch (...) {
 				get_allocator().deallocate(newdata, required_capacity);
 				throw;
@@ -406,17 +500,26 @@ namespace real {
 
 			if (old_begin) {
 				// already moved, delete
-				get_allocator().deallocate(old_begin, old_capacity);
+				details::destroy(old_begin, old_end);
+				get_allocator().deallocate(_begin, old_capacity);
 			}
 
 			_begin    = newdata;
 			_end      = newdata + old_size;
 			_capacity_allocator.second() = required_capacity;
+			_record_reallocation(old_capacity, required_capacity, old_size);
 		}
 
 		constexpr void reserve(size_type new_capacity) {
-			T *    old_begin         = _begin;
-			T *    old_end           = _end;
+			_record_reserve(new_capacity);
+			_reallocate(new_capacity);
+		}
+
+	  private:
+		// reserve() without the on_reserve hook, for growth from inserts
+		constexpr void _reallocate(size_type new_capacity) {
+			T *    old_begin         = ::std::to_address(_begin);
+			T *    old_end           = ::std::to_address(_end);
 			size_t old_size          = static_cast<size_type>(old_end - old_begin);
 			size_t old_capacity      = _capacity_allocator.second();
 			//size_t required_capacity = std::max(old_size, new_capacity);
@@ -425,10 +528,12 @@ namespace real {
 					throw std::length_error("cannot allocate larger than max_size");
 				}
 
-				const pointer newdata = get_allocator().allocate(new_capacity);
+				const auto [newdata, allocated] = details::allocate_at_least(_capacity_allocator.first(), new_capacity);
+				new_capacity                    = allocated;
 				try {
 					// copy data over
-					::std::uninitialized_copy(std::make_move_iterator(old_begin), std::make_move_iterator(old_end), newdata);
+					::std::uninitialized_copy(std::make_move_iterator(old_begin), std::make_move_iterator(old_end),
+					                          ::std::to_address(newdata));
 				} catch (...) {
 					get_allocator().deallocate(newdata, new_capacity);
 					throw;
@@ -436,24 +541,31 @@ namespace real {
 
 				if (old_begin) {
 					// already moved, delete
-					get_allocator().deallocate(old_begin, old_capacity);
+					details::destroy(old_begin, old_end);
+					get_allocator().deallocate(_begin, old_capacity);
 				}
 
 				_begin = newdata;
 				_end   = newdata + old_size;
 				_capacity_allocator.second() = new_capacity;
+				_record_reallocation(old_capacity, new_capacity, old_size);
 			}
 		}
+
+	  public:
 		// note: use only after clear();
 		constexpr void cleared_reserve(size_type new_capacity) {
-			const pointer newdata = get_allocator().allocate(new_capacity);
+			const auto [newdata, allocated] = details::allocate_at_least(_capacity_allocator.first(), new_capacity);
+			const size_type old_capacity    = capacity();
+			new_capacity                    = allocated;
 			if (_begin) {
-				details::destroy(_begin, _end);
+				details::destroy(::std::to_address(_begin), ::std::to_address(_end));
 				get_allocator().deallocate(_begin, capacity());
 			}
 			_begin = newdata;
 			_end   = newdata;
 			_capacity_allocator.second() = new_capacity;
+			_record_reallocation(old_capacity, new_capacity, 0);
 		}
 		//[]'s
 		[[nodiscard]] constexpr reference operator[](size_type pos) {
@@ -484,10 +596,10 @@ namespace real {
 		};
 		// data's
 		[[nodiscard]] constexpr T *data() noexcept {
-			return _begin;
+			return ::std::to_address(_begin);
 		};
 		[[nodiscard]] constexpr const T *data() const noexcept {
-			return _begin;
+			return ::std::to_address(_begin);
 		};
 		// at's
 		[[nodiscard]] constexpr reference at(size_type pos) {
@@ -503,13 +615,13 @@ namespace real {
 
 		// begin's
 		[[nodiscard]] constexpr iterator begin() noexcept {
-			return _begin;
+			return ::std::to_address(_begin);
 		};
 		[[nodiscard]] constexpr const_iterator begin() const noexcept {
-			return _begin;
+			return ::std::to_address(_begin);
 		};
 		[[nodiscard]] constexpr const_iterator cbegin() const noexcept {
-			return _begin;
+			return ::std::to_address(_begin);
 		};
 		// rbegin's
 		[[nodiscard]] constexpr reverse_iterator rbegin() noexcept {
@@ -580,34 +692,37 @@ namespace real {
 			if (full()) {
 				size_t target_capacity = geometric_int_expansion_policy<2>{}.grow_capacity(
 					size(), _capacity_allocator.second(), _capacity_allocator.second() + 1);
-				reserve(target_capacity);
+				_reallocate(target_capacity);
 			}
-			iterator it = _end;
-			_end += 1;
+			iterator it = ::std::to_address(_end);
 			::new ((void *)it) value_type(::std::forward<Args>(args)...);
+			_end += 1;
+			_record_insert(size() - 1, 1);
 			return *it;
 		};
 		// emplace_back_with_policy
-		template <typename... Args, typename ExpansionPolicy>
-		constexpr reference emplace_back_with_policy(Args &&...args, ExpansionPolicy) {
+		template <typename ExpansionPolicy = geometric_int_expansion_policy<2>, typename... Args>
+		constexpr reference emplace_back_with_policy(Args &&...args) {
 			if (full()) {
 				size_t target_capacity = ExpansionPolicy{}.grow_capacity(size(), _capacity_allocator.second(),
 				                                                         _capacity_allocator.second() + 1);
-				reserve(target_capacity);
+				_reallocate(target_capacity);
 			}
-			iterator it = _end;
-			_end += 1;
+			iterator it = ::std::to_address(_end);
 			::new ((void *)it) T(::std::forward<Args>(args)...);
+			_end += 1;
+			_record_insert(size() - 1, 1);
 			return *it;
 		}
 
 		// unechecked_emplace_back (non-standard)
 		template <typename... Args> constexpr reference unchecked_emplace_back(Args &&...args) {
-			iterator it = _end;
-			_end += 1;
+			iterator it = ::std::to_address(_end);
 			//::new ((void *)it) T(::std::forward<Args>(args)...);
 			::std::allocator_traits<allocator_type>::construct(_capacity_allocator.first(), ::std::to_address(it),
 			                                                   std::forward<Args>(args)...);
+			_end += 1;
+			_record_insert(size() - 1, 1);
 			return *it;
 		};
 		// push_back's
@@ -620,12 +735,12 @@ namespace real {
 		// push_back_with_policy
 		template<typename ExpansionPolicy = geometric_int_expansion_policy<2>>
 		constexpr void push_back_with_policy(const T &value) {
-			emplace_back_with_policy(::std::forward<const T &>(value), ExpansionPolicy{});
+			emplace_back_with_policy<ExpansionPolicy>(::std::forward<const T &>(value));
 		}
 
 		template <typename ExpansionPolicy = geometric_int_expansion_policy<2>>
 		constexpr void push_back_with_policy(T &&value) {
-			emplace_back_with_policy(::std::forward<T &&>(value), ExpansionPolicy{});
+			emplace_back_with_policy<ExpansionPolicy>(::std::forward<T &&>(value));
 		}
 		// pop_back's
 		constexpr void pop_back() {
@@ -636,6 +751,7 @@ namespace real {
 					_end -= 1;
 					end()->~element_type(); // destroy the tailing value
 				}
+				_record_erase(size(), 1);
 			} else {
 				//error ?
 			}
@@ -643,9 +759,12 @@ namespace real {
 		// clear
 		constexpr void clear() noexcept {
 			if constexpr (!::std::is_trivially_constructible<element_type>::value) {
-				details::destroy(_begin, _end);
+				details::destroy(begin(), end());
 			}
-			_end = _begin;
+			const size_type old_size = size();
+			_end                     = _begin;
+			if (old_size)
+				_record_erase(0, old_size);
 		}
 		// insert's
 		constexpr iterator insert(const_iterator pos, const T &value) {
@@ -655,20 +774,23 @@ namespace real {
 			return emplace(pos, ::std::move(value));
 		}
 		constexpr iterator insert(const_iterator pos, size_type count, const T &value) {
+			const size_type insert_idx = pos - cbegin();
+			assert(pos >= cbegin() && pos <= cend() && "insert iterator is out of bounds");
 			if (count) {
-				size_type      remaining_capacity = capacity() - size();
-				//const bool     one_at_back        = (remaining_capacity == 1) && (pos == cend());
-				const size_type insert_idx   = cend() - pos;
-				iterator  insert_point = begin() + (cend() - pos);
+				size_type remaining_capacity = capacity() - size();
+				const size_type old_size     = size();
 
 				if (count > remaining_capacity) {
-					//reserve(size()+count);
-					const size_type new_capacity = size() + count;
-					pointer   newdata      = get_allocator().allocate(new_capacity);
+					const auto [newdata, new_capacity] = details::allocate_at_least(
+						_capacity_allocator.first(),
+						geometric_int_expansion_policy<2>{}.grow_capacity(old_size, capacity(), old_size + count));
+					pointer new_first = ::std::to_address(newdata);
 					try {
-						::std::uninitialized_copy(::std::make_move_iterator(begin()), ::std::make_move_iterator(insert_point), newdata);
-						::std::uninitialized_fill(newdata + insert_point, newdata + insert_point + count, value);
-						::std::uninitialized_copy(::std::make_move_iterator(insert_point), ::std::make_move_iterator(end()), newdata + insert_point + count);
+						::std::uninitialized_fill(new_first + insert_idx, new_first + insert_idx + count, value);
+						::std::uninitialized_copy(::std::make_move_iterator(begin()),
+						                          ::std::make_move_iterator(begin() + insert_idx), new_first);
+						::std::uninitialized_copy(::std::make_move_iterator(begin() + insert_idx),
+						                          ::std::make_move_iterator(end()), new_first + insert_idx + count);
 					} catch (...) {
 						get_allocator().deallocate(newdata, new_capacity);
 						throw;
@@ -676,29 +798,41 @@ namespace real {
 
 					if (_begin) {
 						// already moved, delete
+						details::destroy(begin(), end());
 						get_allocator().deallocate(_begin, capacity());
 					}
 
+					const size_type old_capacity = capacity();
 					_begin                       = newdata;
-					_end                         = newdata + new_capacity;
+					_end                         = newdata + old_size + count;
 					_capacity_allocator.second() = new_capacity;
-
+					_record_reallocation(old_capacity, new_capacity, old_size);
 				} else {
-					iterator start  = end();
-					iterator last   = start;
-					iterator target = start + count;
-					//uninitialized_move_backward
-					for (;target != last; target--, start--) {
-						::std::allocator_traits<allocator_type>::construct(_capacity_allocator.first(), 
-							::std::to_address(target), ::std::move(*start));
+					const value_type copy      = value; // value may live inside this vector
+					iterator         old_end   = end();
+					const size_type  tail_size = old_size - insert_idx;
+					if (tail_size > count) {
+						// the last count values move into uninitialized memory, the rest shift over
+						::std::uninitialized_copy(::std::make_move_iterator(old_end - count),
+						                          ::std::make_move_iterator(old_end), old_end);
+						::std::move_backward(begin() + insert_idx, old_end - count, old_end);
+						::std::fill(begin() + insert_idx, begin() + insert_idx + count, copy);
+					} else {
+						// part of the new values land in uninitialized memory
+						::std::uninitialized_fill(old_end, old_end + (count - tail_size), copy);
+						::std::uninitialized_copy(::std::make_move_iterator(begin() + insert_idx),
+						                          ::std::make_move_iterator(old_end), old_end + (count - tail_size));
+						::std::fill(begin() + insert_idx, old_end, copy);
 					}
-					::std::uninitialized_fill(pos, pos + count, value);
-					_end = target;
+					_end += count;
 				}
+				_record_insert(insert_idx, count);
 			}
+			return begin() + insert_idx;
 		}
-		template <class InputIt> constexpr iterator insert(const_iterator pos, InputIt first, InputIt last) {
-			return insert_range(pos, first, last);
+		template <class InputIt, typename = typename ::std::iterator_traits<InputIt>::iterator_category>
+		constexpr iterator insert(const_iterator pos, InputIt first, InputIt last) {
+			return insert_range(pos, first, last, geometric_int_expansion_policy<2>{});
 		};
 		constexpr iterator insert(const_iterator pos, ::std::initializer_list<T> ilist) {
 			return insert(pos, ilist.begin(), ilist.end());
@@ -712,49 +846,52 @@ namespace real {
 				if (pos == cend()) {
 					unchecked_emplace_back(::std::forward<Args>(args)...);
 				} else {
-					iterator start  = end();
-					iterator last   = start;
-					iterator target = start + 1;
-					// uninitialized_move_backward
-					for (; target != last; target--, start--) {
-						::std::allocator_traits<allocator_type>::construct(
-							_capacity_allocator.first(), ::std::to_address(target), ::std::move(*start));
-					}
+					value_type value(::std::forward<Args>(args)...); // args may refer into this vector
+					iterator   old_end = end();
+					// the last value moves into uninitialized memory, the rest shift over
 					::std::allocator_traits<allocator_type>::construct(
-						_capacity_allocator.first(), ::std::to_address(pos), std::forward<Args>(args)...);
-					_end = target;
+						_capacity_allocator.first(), ::std::to_address(old_end), ::std::move(*(old_end - 1)));
+					_end += 1;
+					::std::move_backward(begin() + insert_idx, old_end - 1, old_end);
+					*(begin() + insert_idx) = ::std::move(value);
+					_record_insert(insert_idx, 1);
 				}
 			} else {
 				//emplace_back(std::forward<Args>(args)...);
 				if (pos == cend()) {
 					emplace_back(::std::forward<Args>(args)...);
 				} else {
-					size_type new_capacity =
-						geometric_int_expansion_policy<2>{}.grow_capacity(size(), capacity(), capacity() + 1);
-					const pointer newdata = _capacity_allocator.first().allocate(new_capacity);
+					const auto [newdata, new_capacity] = details::allocate_at_least(
+						_capacity_allocator.first(),
+						geometric_int_expansion_policy<2>{}.grow_capacity(size(), capacity(), capacity() + 1));
+					pointer new_first = ::std::to_address(newdata);
 					try {
 						::std::allocator_traits<allocator_type>::construct(_capacity_allocator.first(),
-						                                                   newdata + insert_idx, std::forward<Args>(args)...);
+						                                                   new_first + insert_idx, std::forward<Args>(args)...);
 						::std::uninitialized_copy( //should handle unwinding themselves
 							::std::make_move_iterator(begin()),
-							::std::make_move_iterator(begin()+insert_idx), newdata);
+							::std::make_move_iterator(begin()+insert_idx), new_first);
 
 						::std::uninitialized_copy(
 							::std::make_move_iterator(begin()+insert_idx),
-						    ::std::make_move_iterator(end()), newdata + insert_idx + 1);
+						    ::std::make_move_iterator(end()), new_first + insert_idx + 1);
 					} catch (...) {
-						details::destroy_at(newdata + insert_idx);
+						details::destroy_at(new_first + insert_idx);
 						_capacity_allocator.first().deallocate(newdata, new_capacity);
 						throw;
 					}
 					
+					size_type old_size     = size();
+					size_type old_capacity = capacity();
 					if (_begin) {
+						details::destroy(begin(), end());
 						_capacity_allocator.first().deallocate(_begin, capacity());
 					}
-					size_type old_size           = size();
 					_begin                       = newdata;
 					_end                         = newdata + old_size + 1;
 					_capacity_allocator.second() = new_capacity;
+					_record_reallocation(old_capacity, new_capacity, old_size);
+					_record_insert(insert_idx, 1);
 				}
 			}
 			return begin()+insert_idx;
@@ -774,6 +911,7 @@ namespace real {
 			}
 			details::destroy_at(end() - 1);
 			_end -= 1;
+			_record_erase(erase_idx, 1);
 			return begin() + erase_idx;
 		}
 		constexpr iterator erase(const_iterator first,
@@ -793,6 +931,7 @@ namespace real {
 				}
 				details::destroy(end() - erase_count, end());
 				_end -= erase_count;
+				_record_erase(erase_idx, erase_count);
 			}
 			return begin() + erase_idx;
 		}
@@ -802,20 +941,24 @@ namespace real {
 			clear();
 			if (count > capacity())
 				cleared_reserve(count);
-			::std::uninitialized_fill(_begin, _begin + count, value);
+			::std::uninitialized_fill(data(), data() + count, value);
 			_end = _begin + count;
+			if (count)
+				_record_insert(0, count);
 		};
 
 		template<typename Iterator>
 		constexpr void assign(Iterator first, Iterator last) {
 			if constexpr (::std::is_same<::std::random_access_iterator_tag,
-			                             ::std::iterator_traits<Iterator>::iterator_category>::value) {
+			                             typename ::std::iterator_traits<Iterator>::iterator_category>::value) {
 				size_type count = static_cast<size_type>(last - first);
 				clear();
 				if (count > capacity())
 					cleared_reserve(count);
 				::std::uninitialized_copy(first, last, end());
 				_end = _begin + count;
+				if (count)
+					_record_insert(0, count);
 			} else {
 				size_type count = std::distance(first, last);
 				clear();
@@ -835,16 +978,17 @@ namespace real {
 			if (this != &other) {
 				_cleanup();
 				details::pocma(_capacity_allocator.first(), other._capacity_allocator.first());
-				_begin                       = ::std::move(other._begin);
-				_end                         = ::std::move(other._end);
-				_capacity_allocator.second() = ::std::move(other._capacity_allocator.second());
+				// other is left empty, it must not free what it handed over
+				_begin                       = ::std::exchange(other._begin, nullptr);
+				_end                         = ::std::exchange(other._end, nullptr);
+				_capacity_allocator.second() = ::std::exchange(other._capacity_allocator.second(), 0);
 			}
 			return *this;
 		}
 
 		constexpr vector &operator=(const vector &other) {
 			if (this != &other) {
-				if constexpr (details::should_pocca(_capacity_allocator.first())) {
+				if constexpr (::std::allocator_traits<Allocator>::propagate_on_container_copy_assignment::value) {
 					if (!::std::allocator_traits<Allocator>::is_always_equal::value &&
 					    _capacity_allocator.first() != other._capacity_allocator.first()) {
 						_cleanup();
@@ -866,8 +1010,10 @@ namespace real {
 		constexpr void shrink_to_fit() {
 			if (size() != capacity()) {
 				if (_begin == _end) {
+					const size_type old_capacity = capacity();
 					_cleanup();
-				} else {
+					_record_reallocation(old_capacity, 0, 0);
+				} else if (details::allocation_size(_capacity_allocator.first(), size()) != capacity()) {
 					unchecked_reserve(size());
 				}
 			}
@@ -875,6 +1021,195 @@ namespace real {
 	};
 
 
+	// bit_vector: packed dynamic bitset (explicitly not a vector<bool> specialization), one bit per value
+	//  bits at or past size() are kept cleared so count() / find_first() / find_next() work a word at a time
+	template <typename Allocator = std::allocator<uint64_t>>
+	class bit_vector {
+	  public:
+		using value_type      = bool;
+		using word_type       = uint64_t;
+		using size_type       = ::std::size_t;
+		using difference_type = ::std::ptrdiff_t;
+		using const_reference = bool;
+		using allocator_type  = Allocator;
+
+		static constexpr size_type word_bits = bit_words::word_bits;
+
+		using reference = bit_words::reference;
+
+	  private:
+		vector<word_type, Allocator> _words;
+		size_type                    _size = {};
+
+	  public:
+		constexpr bit_vector() noexcept(::std::is_nothrow_default_constructible_v<Allocator>) = default;
+
+		constexpr explicit bit_vector(const Allocator &alloc) noexcept : _words(alloc) {
+		}
+
+		constexpr explicit bit_vector(size_type count, bool value = false) {
+			resize(count, value);
+		}
+
+		[[nodiscard]] constexpr allocator_type get_allocator() const noexcept {
+			return _words.get_allocator();
+		}
+
+		//[]'s
+		[[nodiscard]] constexpr reference operator[](size_type pos) noexcept {
+			assert(pos < size());
+			return reference{_words.data() + bit_words::word_index(pos), bit_words::bit_mask(pos)};
+		};
+		[[nodiscard]] constexpr const_reference operator[](size_type pos) const noexcept {
+			assert(pos < size());
+			return (_words[bit_words::word_index(pos)] & bit_words::bit_mask(pos)) != 0;
+		};
+		[[nodiscard]] constexpr bool test(size_type pos) const noexcept {
+			assert(pos < size());
+			return (_words[bit_words::word_index(pos)] & bit_words::bit_mask(pos)) != 0;
+		}
+		// at's
+		[[nodiscard]] constexpr bool at(size_type pos) const {
+			if (!(pos < size()))
+				throw std::out_of_range("accessing index out of range of bit_vector");
+			return test(pos);
+		}
+		// data's, word_count() words of which the bits at or past size() are zero
+		[[nodiscard]] constexpr word_type *data() noexcept {
+			return _words.data();
+		};
+		[[nodiscard]] constexpr const word_type *data() const noexcept {
+			return _words.data();
+		};
+		[[nodiscard]] constexpr size_type word_count() const noexcept {
+			return _words.size();
+		}
+
+		// set / reset / flip's
+		constexpr void set(size_type pos, bool value = true) noexcept {
+			operator[](pos) = value;
+		}
+		constexpr void reset(size_type pos) noexcept {
+			assert(pos < size());
+			_words[bit_words::word_index(pos)] &= ~bit_words::bit_mask(pos);
+		}
+		constexpr void flip(size_type pos) noexcept {
+			assert(pos < size());
+			_words[bit_words::word_index(pos)] ^= bit_words::bit_mask(pos);
+		}
+		// bulk set / reset (non-standard), masks the edge words and writes whole words in between
+		constexpr void set_range(size_type first, size_type last) noexcept {
+			assert(first <= last && last <= size());
+			bit_words::fill_range(_words.data(), first, last, true);
+		}
+		constexpr void reset_range(size_type first, size_type last) noexcept {
+			assert(first <= last && last <= size());
+			bit_words::fill_range(_words.data(), first, last, false);
+		}
+		constexpr void set() noexcept {
+			bit_words::fill_range(_words.data(), 0, size(), true);
+		}
+		constexpr void reset() noexcept {
+			::std::fill(_words.begin(), _words.end(), word_type{0});
+		}
+
+		// count (non-standard), number of set bits
+		[[nodiscard]] constexpr size_type count() const noexcept {
+			return bit_words::count(_words.data(), _words.size());
+		}
+		[[nodiscard]] constexpr bool any() const noexcept {
+			return bit_words::any(_words.data(), _words.size());
+		}
+		[[nodiscard]] constexpr bool none() const noexcept {
+			return !any();
+		}
+		[[nodiscard]] constexpr bool all() const noexcept {
+			return count() == size();
+		}
+
+		// find_first (non-standard), index of the first set bit or size() if there is none
+		[[nodiscard]] constexpr size_type find_first() const noexcept {
+			return bit_words::find_from(_words.data(), _size, 0);
+		}
+		// find_next (non-standard), index of the first set bit after pos or size() if there is none
+		[[nodiscard]] constexpr size_type find_next(size_type pos) const noexcept {
+			return bit_words::find_from(_words.data(), _size, pos + 1);
+		}
+
+		// word at a time combination of masks of the same size
+		constexpr bit_vector &operator&=(const bit_vector &other) noexcept {
+			assert(size() == other.size());
+			for (size_type i = 0; i < _words.size(); i++)
+				_words[i] &= other._words[i];
+			return *this;
+		}
+		constexpr bit_vector &operator|=(const bit_vector &other) noexcept {
+			assert(size() == other.size());
+			for (size_type i = 0; i < _words.size(); i++)
+				_words[i] |= other._words[i];
+			return *this;
+		}
+		constexpr bit_vector &operator^=(const bit_vector &other) noexcept {
+			assert(size() == other.size());
+			for (size_type i = 0; i < _words.size(); i++)
+				_words[i] ^= other._words[i];
+			return *this;
+		}
+
+		// push_back's
+		constexpr void push_back(bool value) {
+			if (!(_size % word_bits))
+				_words.emplace_back(word_type{0});
+			_words[bit_words::word_index(_size)] |= static_cast<word_type>(value) << (_size % word_bits);
+			_size += 1;
+		}
+		// pop_back's
+		constexpr void pop_back() noexcept {
+			if (_size) {
+				_size -= 1;
+				_words[bit_words::word_index(_size)] &= ~bit_words::bit_mask(_size);
+				if (!(_size % word_bits))
+					_words.pop_back();
+			}
+		}
+		// resize, new bits take value
+		constexpr void resize(size_type count, bool value = false) {
+			const size_type old_size = _size;
+			const size_type words    = bit_words::words_for(count);
+			if (words > _words.size())
+				_words.insert(_words.end(), words - _words.size(), word_type{0});
+			else
+				while (_words.size() > words)
+					_words.pop_back();
+			_size = count;
+			if (count > old_size) {
+				bit_words::fill_range(_words.data(), old_size, count, value);
+			} else if (count % word_bits) {
+				_words[words - 1] &= bit_words::range_mask(0, count % word_bits);
+			}
+		}
+		constexpr void reserve(size_type new_capacity) {
+			_words.reserve(bit_words::words_for(new_capacity));
+		}
+		constexpr void shrink_to_fit() {
+			_words.shrink_to_fit();
+		}
+		// clear
+		constexpr void clear() noexcept {
+			_words.clear();
+			_size = 0;
+		}
+
+		[[nodiscard]] constexpr bool empty() const noexcept {
+			return _size == 0;
+		}
+		constexpr size_type size() const noexcept {
+			return _size;
+		}
+		constexpr size_type capacity() const noexcept {
+			return _words.capacity() * word_bits;
+		}
+	};
 } // namespace real
 
 namespace pmr {
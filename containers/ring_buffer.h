@@ -0,0 +1,310 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#if defined(_MSC_VER)
+#define MUST_INLINE __forceinline
+#elif defined(__GNUC__) || defined(__clang__)
+#define MUST_INLINE __attribute__((always_inline))
+#else
+#define MUST_INLINE
+#endif
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2020 Alex Anderson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// ring_buffer: fixed capacity single-producer / single-consumer queue with plain_array style inline storage
+//  N must be a power of two, indices run freely and are masked on access
+//  like plain_array every slot is a live value_type, pushes assign into a slot and pops move out of it
+// mpmc_ring_buffer: bounded multi-producer / multi-consumer variant (per slot sequence numbers)
+
+namespace containers {
+    namespace details {
+        // fixed rather than std::hardware_destructive_interference_size, which varies with compiler flags
+        inline constexpr ::std::size_t cache_line_size = 64;
+
+        constexpr bool is_power_of_two(::std::size_t n) noexcept {
+            return n && !(n & (n - 1));
+        }
+    } // namespace details
+
+    template <typename Ty, size_t N> struct ring_buffer {
+        static_assert(details::is_power_of_two(N), "ring_buffer capacity must be a power of two");
+
+      public:
+        using element_type    = Ty;
+        using value_type      = typename ::std::remove_cv<Ty>::type;
+        using const_reference = const value_type &;
+        using size_type       = ::std::size_t;
+        using difference_type = ::std::ptrdiff_t;
+        using reference       = value_type &;
+
+      private:
+        static constexpr size_type mask = N - 1;
+
+        // consumer owned
+        alignas(details::cache_line_size) ::std::atomic<size_type> _head{0};
+        size_type _cached_tail{0};
+        // producer owned
+        alignas(details::cache_line_size) ::std::atomic<size_type> _tail{0};
+        size_type _cached_head{0};
+        // storage
+        alignas(details::cache_line_size) value_type _values[N]{};
+
+        // producer side, number of free slots (refreshes the cached head only when it has to)
+        MUST_INLINE size_type writable(size_type tail, size_type wanted) noexcept {
+            size_type free_slots = N - (tail - _cached_head);
+            if (free_slots < wanted) {
+                _cached_head = _head.load(::std::memory_order_acquire);
+                free_slots   = N - (tail - _cached_head);
+            }
+            return free_slots;
+        }
+
+        // consumer side, number of filled slots (refreshes the cached tail only when it has to)
+        MUST_INLINE size_type readable(size_type head, size_type wanted) noexcept {
+            size_type filled_slots = _cached_tail - head;
+            if (filled_slots < wanted) {
+                _cached_tail = _tail.load(::std::memory_order_acquire);
+                filled_slots = _cached_tail - head;
+            }
+            return filled_slots;
+        }
+
+      public:
+        constexpr ring_buffer() noexcept = default;
+
+        ring_buffer(const ring_buffer &)            = delete;
+        ring_buffer &operator=(const ring_buffer &) = delete;
+
+        // producer
+        template <typename... Args> bool try_emplace(Args &&...args) {
+            const size_type tail = _tail.load(::std::memory_order_relaxed);
+            if (!writable(tail, 1))
+                return false;
+            _values[tail & mask] = value_type(::std::forward<Args>(args)...);
+            _tail.store(tail + 1, ::std::memory_order_release);
+            return true;
+        }
+
+        bool try_push(const value_type &value) {
+            return try_emplace(value);
+        }
+
+        bool try_push(value_type &&value) {
+            return try_emplace(::std::move(value));
+        }
+
+        // pushes up to count values from first, publishes them with a single store, returns how many were pushed
+        template <typename It> size_type try_push_n(It first, size_type count) {
+            const size_type tail         = _tail.load(::std::memory_order_relaxed);
+            const size_type free_slots   = writable(tail, count);
+            const size_type insert_count = count <= free_slots ? count : free_slots;
+            for (size_type i = 0; i < insert_count; ++i, ++first)
+                _values[(tail + i) & mask] = *first;
+            if (insert_count)
+                _tail.store(tail + insert_count, ::std::memory_order_release);
+            return insert_count;
+        }
+
+        // consumer
+        bool try_pop(value_type &out) {
+            const size_type head = _head.load(::std::memory_order_relaxed);
+            if (!readable(head, 1))
+                return false;
+            out = ::std::move(_values[head & mask]);
+            _head.store(head + 1, ::std::memory_order_release);
+            return true;
+        }
+
+        // pops up to count values into d_first, releases the slots with a single store, returns how many were popped
+        template <typename OutputIt> size_type try_pop_n(OutputIt d_first, size_type count) {
+            const size_type head         = _head.load(::std::memory_order_relaxed);
+            const size_type filled_slots = readable(head, count);
+            const size_type pop_count    = count <= filled_slots ? count : filled_slots;
+            for (size_type i = 0; i < pop_count; ++i, ++d_first)
+                *d_first = ::std::move(_values[(head + i) & mask]);
+            if (pop_count)
+                _head.store(head + pop_count, ::std::memory_order_release);
+            return pop_count;
+        }
+
+        // only exact when called from a quiescent producer or consumer
+        [[nodiscard]] size_type size() const noexcept {
+            const size_type head = _head.load(::std::memory_order_acquire);
+            const size_type tail = _tail.load(::std::memory_order_acquire);
+            return tail - head;
+        }
+        [[nodiscard]] bool empty() const noexcept {
+            return size() == 0;
+        }
+        [[nodiscard]] bool full() const noexcept {
+            return size() == N;
+        }
+        // capacity
+        constexpr size_type capacity() const noexcept {
+            return N;
+        }
+        // max_size
+        constexpr size_type max_size() const noexcept {
+            return N;
+        }
+    };
+
+    template <typename Ty, size_t N> struct mpmc_ring_buffer {
+        static_assert(details::is_power_of_two(N), "mpmc_ring_buffer capacity must be a power of two");
+
+      public:
+        using element_type    = Ty;
+        using value_type      = typename ::std::remove_cv<Ty>::type;
+        using const_reference = const value_type &;
+        using size_type       = ::std::size_t;
+        using difference_type = ::std::ptrdiff_t;
+        using reference       = value_type &;
+
+      private:
+        static constexpr size_type mask = N - 1;
+
+        // sequence == position: free for the producer claiming position
+        // sequence == position + 1: filled for the consumer claiming position
+        struct cell {
+            ::std::atomic<size_type> _sequence;
+            value_type               _value{};
+        };
+
+        alignas(details::cache_line_size) ::std::atomic<size_type> _enqueue_pos{0};
+        alignas(details::cache_line_size) ::std::atomic<size_type> _dequeue_pos{0};
+        alignas(details::cache_line_size) cell _cells[N];
+
+        // claims up to count consecutive positions whose cells have sequence == pos + i + offset
+        MUST_INLINE size_type claim(::std::atomic<size_type> &position, size_type offset, size_type count,
+                                    size_type &first_pos) noexcept {
+            size_type pos = position.load(::std::memory_order_relaxed);
+            for (;;) {
+                size_type ready = 0;
+                for (; ready < count; ++ready) {
+                    const size_type seq = _cells[(pos + ready) & mask]._sequence.load(::std::memory_order_acquire);
+                    if (seq != pos + ready + offset)
+                        break;
+                }
+                if (!ready) {
+                    const size_type seq = _cells[pos & mask]._sequence.load(::std::memory_order_acquire);
+                    // behind: the queue is full (or empty), otherwise another thread moved position on
+                    if (static_cast<difference_type>(seq - (pos + offset)) < 0)
+                        return 0;
+                    pos = position.load(::std::memory_order_relaxed);
+                    continue;
+                }
+                // cells at [pos, pos + ready) can only change hands after position moves past pos
+                if (position.compare_exchange_weak(pos, pos + ready, ::std::memory_order_relaxed)) {
+                    first_pos = pos;
+                    return ready;
+                }
+            }
+        }
+
+      public:
+        mpmc_ring_buffer() noexcept {
+            for (size_type i = 0; i < N; i++)
+                _cells[i]._sequence.store(i, ::std::memory_order_relaxed);
+        }
+
+        mpmc_ring_buffer(const mpmc_ring_buffer &)            = delete;
+        mpmc_ring_buffer &operator=(const mpmc_ring_buffer &) = delete;
+
+        // producer
+        template <typename... Args> bool try_emplace(Args &&...args) {
+            size_type pos = 0;
+            if (!claim(_enqueue_pos, 0, 1, pos))
+                return false;
+            cell &c  = _cells[pos & mask];
+            c._value = value_type(::std::forward<Args>(args)...);
+            c._sequence.store(pos + 1, ::std::memory_order_release);
+            return true;
+        }
+
+        bool try_push(const value_type &value) {
+            return try_emplace(value);
+        }
+
+        bool try_push(value_type &&value) {
+            return try_emplace(::std::move(value));
+        }
+
+        // claims a run of up to count free slots at once, returns how many values were pushed
+        template <typename It> size_type try_push_n(It first, size_type count) {
+            size_type       pos          = 0;
+            const size_type insert_count = count ? claim(_enqueue_pos, 0, count, pos) : 0;
+            for (size_type i = 0; i < insert_count; ++i, ++first) {
+                cell &c  = _cells[(pos + i) & mask];
+                c._value = *first;
+                c._sequence.store(pos + i + 1, ::std::memory_order_release);
+            }
+            return insert_count;
+        }
+
+        // consumer
+        bool try_pop(value_type &out) {
+            size_type pos = 0;
+            if (!claim(_dequeue_pos, 1, 1, pos))
+                return false;
+            cell &c = _cells[pos & mask];
+            out     = ::std::move(c._value);
+            c._sequence.store(pos + N, ::std::memory_order_release);
+            return true;
+        }
+
+        // claims a run of up to count filled slots at once, returns how many values were popped
+        template <typename OutputIt> size_type try_pop_n(OutputIt d_first, size_type count) {
+            size_type       pos       = 0;
+            const size_type pop_count = count ? claim(_dequeue_pos, 1, count, pos) : 0;
+            for (size_type i = 0; i < pop_count; ++i, ++d_first) {
+                cell &c  = _cells[(pos + i) & mask];
+                *d_first = ::std::move(c._value);
+                c._sequence.store(pos + i + N, ::std::memory_order_release);
+            }
+            return pop_count;
+        }
+
+        // approximate under contention
+        [[nodiscard]] size_type size() const noexcept {
+            const size_type head = _dequeue_pos.load(::std::memory_order_acquire);
+            const size_type tail = _enqueue_pos.load(::std::memory_order_acquire);
+            return static_cast<difference_type>(tail - head) > 0 ? tail - head : 0;
+        }
+        [[nodiscard]] bool empty() const noexcept {
+            return size() == 0;
+        }
+        // capacity
+        constexpr size_type capacity() const noexcept {
+            return N;
+        }
+        // max_size
+        constexpr size_type max_size() const noexcept {
+            return N;
+        }
+    };
+} // namespace containers
@@ -0,0 +1,205 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2020 Alex Anderson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// zero-copy snapshots of trivially copyable values: a serialized_header then the raw values
+//  serialize(out, values) writes real::vector, plain_array, std::vector (anything with data() / size()) or
+//  stable_stack (gathered block by block) with one write per contiguous run
+//  gather(values) returns those runs, header included, for writev / sendmsg / async io
+//  view_from<T>(bytes) checks the header and returns a read-only span over the values inside bytes, the buffer
+//  (a mapped file, a received message) must outlive the span and be aligned for T
+// the type hash comes from the compiler's spelling of T, so writer and reader need the same compiler family,
+//  specialize serialized_type<T> with a fixed hash to share snapshots wider, values are in native byte order
+//  (a byte order mismatch is detected, not converted)
+//
+//	containers::serialize(file, real_vector_of_points);
+//	...
+//	std::span<const point> points = containers::view_from<point>(mapped_bytes);
+
+namespace containers {
+    namespace details {
+        constexpr uint64_t fnv1a(::std::string_view text) noexcept {
+            uint64_t hash = 14695981039346656037ull;
+            for (char c : text) {
+                hash ^= static_cast<unsigned char>(c);
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+
+        template <typename T> constexpr ::std::string_view type_signature() noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+            return __FUNCSIG__;
+#else
+            return __PRETTY_FUNCTION__;
+#endif
+        }
+    } // namespace details
+
+    template <typename T> struct serialized_type {
+        static constexpr uint64_t hash = details::fnv1a(details::type_signature<T>());
+    };
+
+    struct serialized_header {
+        char     magic[8];
+        uint64_t byte_order; // 0x0102030405060708 as written
+        uint64_t type_hash;
+        uint64_t element_size;
+        uint64_t alignment;
+        uint64_t count;
+    };
+
+    inline constexpr char     serialized_magic[8] = {'c', 'o', 'n', 't', 's', 'e', 'r', '1'};
+    inline constexpr uint64_t serialized_byte_order = 0x0102030405060708ull;
+
+    // values follow the header at the next multiple of their alignment
+    [[nodiscard]] constexpr ::std::size_t serialized_data_offset(::std::size_t alignment) noexcept {
+        return (sizeof(serialized_header) + alignment - 1) / alignment * alignment;
+    }
+
+    template <typename T> [[nodiscard]] serialized_header make_serialized_header(::std::size_t count) noexcept {
+        static_assert(::std::is_trivially_copyable<T>::value, "only trivially copyable values serialize as bytes");
+        serialized_header header = {};
+        ::std::memcpy(header.magic, serialized_magic, sizeof(header.magic));
+        header.byte_order   = serialized_byte_order;
+        header.type_hash    = serialized_type<T>::hash;
+        header.element_size = sizeof(T);
+        header.alignment    = alignof(T);
+        header.count        = count;
+        return header;
+    }
+
+    // a gather list: the header, zero padding up to the values, then each contiguous run of values
+    struct serialized_buffers {
+        serialized_header                             header;
+        ::std::vector<::std::span<const ::std::byte>> buffers;
+
+        serialized_buffers() = default;
+        // buffers[0] points at header, so the list is pinned to this object
+        serialized_buffers(const serialized_buffers &)            = delete;
+        serialized_buffers &operator=(const serialized_buffers &) = delete;
+
+        [[nodiscard]] ::std::size_t size_bytes() const noexcept {
+            ::std::size_t bytes = 0;
+            for (const ::std::span<const ::std::byte> &buffer : buffers)
+                bytes += buffer.size();
+            return bytes;
+        }
+    };
+
+    namespace details {
+        inline constexpr ::std::byte serialized_padding[64] = {};
+
+        template <typename T> void begin_gather(serialized_buffers &out, ::std::size_t count) {
+            out.header = make_serialized_header<T>(count);
+            out.buffers.clear();
+            out.buffers.emplace_back(reinterpret_cast<const ::std::byte *>(&out.header), sizeof(serialized_header));
+            ::std::size_t padding = serialized_data_offset(alignof(T)) - sizeof(serialized_header);
+            while (padding) {
+                const ::std::size_t chunk = padding < sizeof(serialized_padding) ? padding : sizeof(serialized_padding);
+                out.buffers.emplace_back(serialized_padding, chunk);
+                padding -= chunk;
+            }
+        }
+
+        template <typename T> void add_gather(serialized_buffers &out, const T *values, ::std::size_t count) {
+            if (count)
+                out.buffers.emplace_back(reinterpret_cast<const ::std::byte *>(values), count * sizeof(T));
+        }
+    } // namespace details
+
+    // contiguous containers: one run
+    template <typename Container>
+        requires requires(const Container &c) {
+            c.data();
+            c.size();
+        }
+    void gather(const Container &values, serialized_buffers &out) {
+        using T = ::std::remove_cv_t<::std::remove_pointer_t<decltype(values.data())>>;
+        details::begin_gather<T>(out, values.size());
+        details::add_gather(out, values.data(), values.size());
+    }
+
+    // block containers (stable_stack): one run per block, Container::block_size values each
+    template <typename Container>
+        requires requires(const Container &c) {
+            Container::block_size;
+            c[0];
+            c.size();
+        }
+    void gather(const Container &values, serialized_buffers &out) {
+        using T                       = typename Container::value_type;
+        constexpr ::std::size_t block = Container::block_size;
+        const ::std::size_t     count = values.size();
+        details::begin_gather<T>(out, count);
+        for (::std::size_t first = 0; first < count; first += block)
+            details::add_gather(out, &values[first], count - first < block ? count - first : block);
+    }
+
+    template <typename Container> void serialize(::std::ostream &out, const Container &values) {
+        serialized_buffers gathered;
+        gather(values, gathered);
+        for (const ::std::span<const ::std::byte> &buffer : gathered.buffers)
+            out.write(reinterpret_cast<const char *>(buffer.data()), static_cast<::std::streamsize>(buffer.size()));
+    }
+
+    template <typename Container> [[nodiscard]] ::std::size_t serialized_size(const Container &values) {
+        using T = ::std::remove_cvref_t<decltype(values[0])>;
+        return serialized_data_offset(alignof(T)) + values.size() * sizeof(T);
+    }
+
+    // the values of a serialize()d buffer, throws std::runtime_error when bytes holds something else
+    //  trailing bytes after the values are allowed, the span covers exactly header.count values
+    template <typename T> [[nodiscard]] ::std::span<const T> view_from(::std::span<const ::std::byte> bytes) {
+        static_assert(::std::is_trivially_copyable<T>::value, "only trivially copyable values serialize as bytes");
+        serialized_header header;
+        if (bytes.size() < sizeof(header))
+            throw ::std::runtime_error("view_from: buffer smaller than a serialized_header");
+        ::std::memcpy(&header, bytes.data(), sizeof(header));
+        if (::std::memcmp(header.magic, serialized_magic, sizeof(header.magic)) != 0)
+            throw ::std::runtime_error("view_from: not a serialized container");
+        if (header.byte_order != serialized_byte_order)
+            throw ::std::runtime_error("view_from: written with another byte order");
+        if (header.type_hash != serialized_type<T>::hash || header.element_size != sizeof(T) ||
+            header.alignment != alignof(T))
+            throw ::std::runtime_error("view_from: written for another type");
+        const ::std::size_t offset = serialized_data_offset(alignof(T));
+        if (bytes.size() < offset || header.count > (bytes.size() - offset) / sizeof(T))
+            throw ::std::runtime_error("view_from: buffer is truncated");
+        const ::std::byte *first = bytes.data() + offset;
+        if (reinterpret_cast<::std::uintptr_t>(first) % alignof(T) != 0)
+            throw ::std::runtime_error("view_from: buffer is not aligned for the values");
+        return {reinterpret_cast<const T *>(first), static_cast<::std::size_t>(header.count)};
+    }
+} // namespace containers
@@ -0,0 +1,584 @@
+#pragma once
+#include "real_vector.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2021 Alex Anderson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// shm_vector<T>: a real::vector living in a POSIX shared memory segment, usable from every process mapping it
+//  offset_ptr<T> stores the distance from itself to its target instead of an address, so a pointer stored inside
+//  the segment stays valid wherever each process happens to map it, real::vector stores the allocator's pointer
+//  type so a vector built on shm_allocator keeps offset_ptr's and only converts to raw pointers for iterators
+//  shm_segment opens (shm_open + mmap) a fixed size segment holding a small first fit allocator (guarded by a
+//  process shared mutex) and a table of named objects, the vector itself must be constructed inside the segment
+//  with find_or_construct, a vector on the stack would hold offsets relative to the stack
+//  the vector is not synchronized, lock segment.mutex() around changes that other processes may observe, or
+//  build it in one process and hand it to readers when it's done, reserve() up front to avoid fragmenting the
+//  segment with the buffers growth leaves behind
+//
+//	real::shm_segment segment("/features", real::shm_mode::open_or_create, 1ull << 32);
+//	auto &features = segment.find_or_construct<real::shm_vector<float>>("features", segment.allocator<float>());
+//	{
+//		std::lock_guard<real::shm_mutex> lock(segment.mutex());
+//		features.push_back(1.0f);
+//	}
+//	// in another process, mapped at another address
+//	real::shm_segment segment("/features", real::shm_mode::open);
+//	auto *features = segment.find<real::shm_vector<float>>("features");
+
+namespace real {
+	// a self relative pointer, the offset 1 stands for nullptr
+	template <typename T> class offset_ptr {
+	  public:
+		using element_type      = T;
+		using value_type        = typename ::std::remove_cv<T>::type;
+		using difference_type   = ::std::ptrdiff_t;
+		using pointer           = offset_ptr;
+		using reference         = typename ::std::add_lvalue_reference<T>::type;
+		using iterator_category = ::std::random_access_iterator_tag;
+		template <typename U> using rebind = offset_ptr<U>;
+
+	  private:
+		::std::ptrdiff_t _offset = 1;
+
+		void _set(T *target) noexcept {
+			_offset = target ? static_cast<::std::ptrdiff_t>(reinterpret_cast<::std::uintptr_t>(target) -
+			                                                 reinterpret_cast<::std::uintptr_t>(this))
+			                 : 1;
+		}
+
+	  public:
+		offset_ptr() noexcept = default;
+		offset_ptr(::std::nullptr_t) noexcept {
+		}
+		offset_ptr(T *target) noexcept {
+			_set(target);
+		}
+		// copies re-measure the distance from their own address
+		offset_ptr(const offset_ptr &other) noexcept {
+			_set(other.get());
+		}
+		template <typename U>
+		explicit(!::std::is_convertible<U *, T *>::value) offset_ptr(const offset_ptr<U> &other) noexcept {
+			_set(static_cast<T *>(other.get()));
+		}
+		offset_ptr &operator=(const offset_ptr &other) noexcept {
+			_set(other.get());
+			return *this;
+		}
+		offset_ptr &operator=(T *target) noexcept {
+			_set(target);
+			return *this;
+		}
+		offset_ptr &operator=(::std::nullptr_t) noexcept {
+			_offset = 1;
+			return *this;
+		}
+
+		template <typename U = T>
+			requires(!::std::is_void<U>::value)
+		[[nodiscard]] static offset_ptr pointer_to(U &target) noexcept {
+			return offset_ptr(::std::addressof(target));
+		}
+
+		[[nodiscard]] T *get() const noexcept {
+			return _offset == 1 ? nullptr
+			                    : reinterpret_cast<T *>(reinterpret_cast<::std::uintptr_t>(this) +
+			                                            static_cast<::std::uintptr_t>(_offset));
+		}
+		[[nodiscard]] T *operator->() const noexcept {
+			return get();
+		}
+		[[nodiscard]] reference operator*() const noexcept {
+			return *get();
+		}
+		[[nodiscard]] reference operator[](difference_type n) const noexcept {
+			return get()[n];
+		}
+		explicit operator bool() const noexcept {
+			return _offset != 1;
+		}
+
+		offset_ptr &operator+=(difference_type n) noexcept {
+			_set(get() + n);
+			return *this;
+		}
+		offset_ptr &operator-=(difference_type n) noexcept {
+			_set(get() - n);
+			return *this;
+		}
+		offset_ptr &operator++() noexcept {
+			return *this += 1;
+		}
+		offset_ptr &operator--() noexcept {
+			return *this -= 1;
+		}
+		offset_ptr operator++(int) noexcept {
+			offset_ptr old = *this;
+			*this += 1;
+			return old;
+		}
+		offset_ptr operator--(int) noexcept {
+			offset_ptr old = *this;
+			*this -= 1;
+			return old;
+		}
+		[[nodiscard]] friend offset_ptr operator+(const offset_ptr &p, difference_type n) noexcept {
+			return offset_ptr(p.get() + n);
+		}
+		[[nodiscard]] friend offset_ptr operator+(difference_type n, const offset_ptr &p) noexcept {
+			return offset_ptr(p.get() + n);
+		}
+		[[nodiscard]] friend offset_ptr operator-(const offset_ptr &p, difference_type n) noexcept {
+			return offset_ptr(p.get() - n);
+		}
+		[[nodiscard]] friend difference_type operator-(const offset_ptr &left, const offset_ptr &right) noexcept {
+			return left.get() - right.get();
+		}
+
+		[[nodiscard]] friend bool operator==(const offset_ptr &left, const offset_ptr &right) noexcept {
+			return left.get() == right.get();
+		}
+		[[nodiscard]] friend bool operator==(const offset_ptr &left, ::std::nullptr_t) noexcept {
+			return !left;
+		}
+		[[nodiscard]] friend ::std::strong_ordering operator<=>(const offset_ptr &left,
+		                                                        const offset_ptr &right) noexcept {
+			return ::std::compare_three_way{}(left.get(), right.get());
+		}
+	};
+
+	enum class shm_mode { create, open, open_or_create };
+
+	namespace details {
+		struct shm_free_block {
+			uint64_t size;
+			uint64_t next; // offset of the next free block, 0 ends the list
+		};
+
+		struct shm_name {
+			char     name[48];
+			uint64_t offset; // 0 for an unused slot
+		};
+
+		struct shm_header {
+			char                    magic[8];
+			::std::atomic<uint32_t> ready;
+			uint64_t                bytes;
+			uint64_t                top;       // offset of the untouched rest of the segment
+			uint64_t                free_list; // free blocks below top sorted by offset
+			pthread_mutex_t         allocator_lock;
+			pthread_mutex_t         user_lock;
+			shm_name                names[32];
+		};
+
+		inline constexpr char     shm_magic[8] = {'r', 'e', 'a', 'l', 's', 'h', 'm', '1'};
+		inline constexpr uint64_t shm_granule  = sizeof(shm_free_block);
+
+		[[nodiscard]] constexpr uint64_t shm_round_up(uint64_t value, uint64_t alignment) noexcept {
+			return (value + alignment - 1) / alignment * alignment;
+		}
+
+		// a recursive (constructors of named objects allocate) process shared mutex, robust where supported
+		inline void shm_init_mutex(pthread_mutex_t *mutex) {
+			pthread_mutexattr_t attributes;
+			pthread_mutexattr_init(&attributes);
+			pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+			pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+#if defined(__linux__)
+			pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+#endif
+			const int error = pthread_mutex_init(mutex, &attributes);
+			pthread_mutexattr_destroy(&attributes);
+			if (error)
+				throw ::std::system_error(error, ::std::generic_category(), "pthread_mutex_init");
+		}
+
+		// a holder that died leaves the mutex to the next locker, whatever it guarded may be half written
+		inline void shm_lock(pthread_mutex_t *mutex) {
+			const int error = pthread_mutex_lock(mutex);
+#if defined(__linux__)
+			if (error == EOWNERDEAD) {
+				pthread_mutex_consistent(mutex);
+				return;
+			}
+#endif
+			if (error)
+				throw ::std::system_error(error, ::std::generic_category(), "pthread_mutex_lock");
+		}
+
+		struct shm_lock_guard {
+			pthread_mutex_t *mutex;
+			explicit shm_lock_guard(pthread_mutex_t *m) : mutex(m) {
+				shm_lock(mutex);
+			}
+			~shm_lock_guard() {
+				pthread_mutex_unlock(mutex);
+			}
+			shm_lock_guard(const shm_lock_guard &)            = delete;
+			shm_lock_guard &operator=(const shm_lock_guard &) = delete;
+		};
+
+		[[nodiscard]] inline shm_free_block *shm_block_at(shm_header *header, uint64_t offset) noexcept {
+			return reinterpret_cast<shm_free_block *>(reinterpret_cast<char *>(header) + offset);
+		}
+
+		// returns the block to the sorted free list, merging neighbours and giving the last block back to top
+		inline void shm_deallocate(shm_header *header, uint64_t offset, uint64_t bytes) {
+			bytes = shm_round_up(bytes ? bytes : 1, shm_granule);
+			shm_lock_guard lock(&header->allocator_lock);
+
+			uint64_t *link     = &header->free_list;
+			uint64_t  previous = 0;
+			while (*link && *link < offset) {
+				previous = *link;
+				link     = &shm_block_at(header, *link)->next;
+			}
+			shm_free_block *block = shm_block_at(header, offset);
+			block->size           = bytes;
+			block->next           = *link;
+			*link                 = offset;
+			if (block->next && offset + block->size == block->next) {
+				block->size += shm_block_at(header, block->next)->size;
+				block->next = shm_block_at(header, block->next)->next;
+			}
+			if (previous && previous + shm_block_at(header, previous)->size == offset) {
+				shm_block_at(header, previous)->size += block->size;
+				shm_block_at(header, previous)->next = block->next;
+				offset                                = previous;
+				block                                 = shm_block_at(header, previous);
+			}
+			if (offset + block->size == header->top && !block->next) {
+				header->top = offset;
+				uint64_t *last = &header->free_list;
+				while (*last != offset)
+					last = &shm_block_at(header, *last)->next;
+				*last = 0;
+			}
+		}
+
+		// first fit from the free list, then from top, 0 when the segment is full
+		[[nodiscard]] inline uint64_t shm_allocate(shm_header *header, uint64_t bytes, uint64_t alignment) {
+			bytes     = shm_round_up(bytes ? bytes : 1, shm_granule);
+			alignment = alignment < shm_granule ? shm_granule : alignment;
+			shm_lock_guard lock(&header->allocator_lock);
+
+			for (uint64_t *link = &header->free_list; *link; link = &shm_block_at(header, *link)->next) {
+				shm_free_block *block = shm_block_at(header, *link);
+				if (*link % alignment == 0 && block->size >= bytes) {
+					const uint64_t offset = *link;
+					if (block->size > bytes) {
+						shm_free_block *rest = shm_block_at(header, offset + bytes);
+						rest->size           = block->size - bytes;
+						rest->next           = block->next;
+						*link                = offset + bytes;
+					} else {
+						*link = block->next;
+					}
+					return offset;
+				}
+			}
+
+			const uint64_t gap    = header->top;
+			const uint64_t offset = shm_round_up(header->top, alignment);
+			if (offset > header->bytes || bytes > header->bytes - offset)
+				return 0;
+			header->top = offset + bytes;
+			// an alignment above shm_granule leaves a gap below offset, it goes on the free list (the lock is recursive)
+			if (offset != gap)
+				shm_deallocate(header, gap, offset - gap);
+			return offset;
+		}
+	} // namespace details
+
+	// a handle on the segment's user mutex, for std::lock_guard / std::unique_lock
+	class shm_mutex {
+		pthread_mutex_t *_mutex = nullptr;
+
+	  public:
+		explicit shm_mutex(pthread_mutex_t *mutex) noexcept : _mutex(mutex) {
+		}
+		void lock() {
+			details::shm_lock(_mutex);
+		}
+		bool try_lock() {
+			const int error = pthread_mutex_trylock(_mutex);
+#if defined(__linux__)
+			if (error == EOWNERDEAD) {
+				pthread_mutex_consistent(_mutex);
+				return true;
+			}
+#endif
+			return error == 0;
+		}
+		void unlock() noexcept {
+			pthread_mutex_unlock(_mutex);
+		}
+	};
+
+	template <typename T> class shm_allocator {
+		template <typename U> friend class shm_allocator;
+		offset_ptr<details::shm_header> _header;
+
+	  public:
+		using value_type                             = T;
+		using pointer                                = offset_ptr<T>;
+		using const_pointer                          = offset_ptr<const T>;
+		using void_pointer                           = offset_ptr<void>;
+		using const_void_pointer                     = offset_ptr<const void>;
+		using size_type                              = ::std::size_t;
+		using difference_type                        = ::std::ptrdiff_t;
+		using propagate_on_container_move_assignment = ::std::true_type;
+		using is_always_equal                        = ::std::false_type;
+
+		explicit shm_allocator(details::shm_header *header) noexcept : _header(header) {
+		}
+		shm_allocator(const shm_allocator &other) noexcept : _header(other._header) {
+		}
+		template <typename U> shm_allocator(const shm_allocator<U> &other) noexcept : _header(other._header) {
+		}
+		shm_allocator &operator=(const shm_allocator &other) noexcept {
+			_header = other._header;
+			return *this;
+		}
+
+		// throws std::bad_alloc when the segment has no room left
+		[[nodiscard]] pointer allocate(size_type count) {
+			if (count > static_cast<size_type>(-1) / sizeof(T))
+				throw ::std::bad_alloc();
+			const uint64_t offset = details::shm_allocate(_header.get(), count * sizeof(T), alignof(T));
+			if (!offset)
+				throw ::std::bad_alloc();
+			return pointer(reinterpret_cast<T *>(reinterpret_cast<char *>(_header.get()) + offset));
+		}
+		void deallocate(pointer p, size_type count) noexcept {
+			const uint64_t offset = static_cast<uint64_t>(reinterpret_cast<char *>(p.get()) -
+			                                              reinterpret_cast<char *>(_header.get()));
+			details::shm_deallocate(_header.get(), offset, count * sizeof(T));
+		}
+
+		template <typename U> [[nodiscard]] bool operator==(const shm_allocator<U> &other) const noexcept {
+			return _header == other._header;
+		}
+	};
+
+	template <typename T> using shm_vector = vector<T, shm_allocator<T>>;
+
+	// a mapping of a named shared memory segment, closing it leaves the segment (and its objects) to other
+	//  processes, remove() unlinks the name once everyone is done
+	class shm_segment {
+		int                  _fd     = -1;
+		details::shm_header *_header = nullptr;
+		::std::size_t        _bytes  = 0;
+		shm_mutex            _mutex{nullptr};
+
+		[[noreturn]] static void _throw_errno(const char *what) {
+			throw ::std::system_error(errno, ::std::generic_category(), what);
+		}
+
+		void _map(::std::size_t bytes) {
+			void *map = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+			if (map == MAP_FAILED)
+				_throw_errno("mmap");
+			_header = static_cast<details::shm_header *>(map);
+			_bytes  = bytes;
+			_mutex  = shm_mutex(&_header->user_lock);
+		}
+
+		void _create(::std::size_t bytes) {
+			if (bytes < details::shm_round_up(sizeof(details::shm_header), 64))
+				throw ::std::invalid_argument("shm_segment: too small for its header");
+			if (::ftruncate(_fd, static_cast<off_t>(bytes)) != 0)
+				_throw_errno("ftruncate");
+			_map(bytes);
+			details::shm_header *header = ::new ((void *)_header) details::shm_header();
+			::std::memcpy(header->magic, details::shm_magic, sizeof(header->magic));
+			header->bytes     = bytes;
+			header->top       = details::shm_round_up(sizeof(details::shm_header), 64);
+			header->free_list = 0;
+			details::shm_init_mutex(&header->allocator_lock);
+			details::shm_init_mutex(&header->user_lock);
+			header->ready.store(1, ::std::memory_order_release);
+		}
+
+		// waits (up to a few seconds) for the creator to size and initialize the segment
+		void _open() {
+			const auto deadline = ::std::chrono::steady_clock::now() + ::std::chrono::seconds(5);
+			struct stat info    = {};
+			for (;;) {
+				if (::fstat(_fd, &info) != 0)
+					_throw_errno("fstat");
+				if (static_cast<::std::size_t>(info.st_size) >= sizeof(details::shm_header))
+					break;
+				if (::std::chrono::steady_clock::now() > deadline)
+					throw ::std::runtime_error("shm_segment: segment was never sized");
+				::std::this_thread::yield();
+			}
+			_map(static_cast<::std::size_t>(info.st_size));
+			while (!_header->ready.load(::std::memory_order_acquire)) {
+				if (::std::chrono::steady_clock::now() > deadline)
+					throw ::std::runtime_error("shm_segment: segment was never initialized");
+				::std::this_thread::yield();
+			}
+			if (::std::memcmp(_header->magic, details::shm_magic, sizeof(_header->magic)) != 0 ||
+			    _header->bytes != _bytes)
+				throw ::std::runtime_error("shm_segment: not a real::shm_segment");
+		}
+
+		void _close() noexcept {
+			if (_header)
+				::munmap(_header, _bytes);
+			if (_fd != -1)
+				::close(_fd);
+			_header = nullptr;
+			_fd     = -1;
+			_bytes  = 0;
+		}
+
+		[[nodiscard]] details::shm_name *_find_name(const char *name) const noexcept {
+			for (details::shm_name &slot : _header->names)
+				if (slot.offset && ::std::strncmp(slot.name, name, sizeof(slot.name)) == 0)
+					return &slot;
+			return nullptr;
+		}
+
+	  public:
+		// name follows shm_open ("/name"), bytes is the fixed size of a created segment
+		shm_segment(const char *name, shm_mode mode, ::std::size_t bytes = 0) {
+			try {
+				if (mode != shm_mode::open) {
+					_fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+					if (_fd != -1) {
+						_create(bytes);
+						return;
+					}
+					if (errno != EEXIST || mode == shm_mode::create)
+						_throw_errno(name);
+				}
+				_fd = ::shm_open(name, O_RDWR | O_CLOEXEC, 0600);
+				if (_fd == -1)
+					_throw_errno(name);
+				_open();
+			} catch (...) {
+				_close();
+				throw;
+			}
+		}
+
+		shm_segment(const shm_segment &)            = delete;
+		shm_segment &operator=(const shm_segment &) = delete;
+
+		~shm_segment() {
+			_close();
+		}
+
+		// unlinks the name, mappings stay usable until they close
+		static bool remove(const char *name) noexcept {
+			return ::shm_unlink(name) == 0;
+		}
+
+		[[nodiscard]] ::std::size_t size() const noexcept {
+			return _bytes;
+		}
+		[[nodiscard]] void *base() const noexcept {
+			return _header;
+		}
+		[[nodiscard]] shm_mutex &mutex() noexcept {
+			return _mutex;
+		}
+		template <typename T> [[nodiscard]] shm_allocator<T> allocator() const noexcept {
+			return shm_allocator<T>(_header);
+		}
+
+		// the object registered under name, nullptr when there is none
+		template <typename T> [[nodiscard]] T *find(const char *name) const {
+			details::shm_lock_guard lock(&_header->allocator_lock);
+			details::shm_name      *slot = _find_name(name);
+			return slot ? reinterpret_cast<T *>(reinterpret_cast<char *>(_header) + slot->offset) : nullptr;
+		}
+
+		// the object registered under name, constructed from args by the first process to ask
+		template <typename T, typename... Args> T &find_or_construct(const char *name, Args &&...args) {
+			if (::std::strlen(name) >= sizeof(details::shm_name::name))
+				throw ::std::length_error("shm_segment: object name too long");
+			details::shm_lock_guard lock(&_header->allocator_lock);
+			if (details::shm_name *slot = _find_name(name))
+				return *reinterpret_cast<T *>(reinterpret_cast<char *>(_header) + slot->offset);
+
+			details::shm_name *free_slot = nullptr;
+			for (details::shm_name &slot : _header->names)
+				if (!slot.offset) {
+					free_slot = &slot;
+					break;
+				}
+			if (!free_slot)
+				throw ::std::length_error("shm_segment: no free name slots");
+			const uint64_t offset = details::shm_allocate(_header, sizeof(T), alignof(T));
+			if (!offset)
+				throw ::std::bad_alloc();
+			T *object;
+			try {
+				object = ::new ((void *)(reinterpret_cast<char *>(_header) + offset)) T(::std::forward<Args>(args)...);
+			} catch (...) {
+				details::shm_deallocate(_header, offset, sizeof(T));
+				throw;
+			}
+			::std::memcpy(free_slot->name, name, ::std::strlen(name) + 1); // length checked above
+			free_slot->offset = offset;
+			return *object;
+		}
+
+		// destroys and frees the object registered under name
+		template <typename T> bool destroy(const char *name) {
+			details::shm_lock_guard lock(&_header->allocator_lock);
+			details::shm_name      *slot = _find_name(name);
+			if (!slot)
+				return false;
+			const uint64_t offset = slot->offset;
+			slot->offset          = 0;
+			reinterpret_cast<T *>(reinterpret_cast<char *>(_header) + offset)->~T();
+			details::shm_deallocate(_header, offset, sizeof(T));
+			return true;
+		}
+	};
+} // namespace real
@@ -0,0 +1,117 @@
+#pragma once
+#include "real_vector.h"
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2021 Alex Anderson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// simd_allocator<T, Align, ZeroFill>: allocates Align aligned blocks (32 for AVX2, 64 for AVX-512 and cache lines)
+//  rounded up to a multiple of Align bytes, through allocate_at_least, so a real::vector using it reports the
+//  rounded size as its capacity()
+//  data() is always Align aligned and capacity() a multiple of lanes, a kernel can run full width loads over
+//  [0, size() rounded up to lanes) without a scalar epilogue, the lanes past size() are the vector's own storage
+//  ZeroFill zeroes every block it hands out, those lanes read as zero until the vector writes there (pop_back,
+//  erase and clear leave old values behind, zero_tail() clears them again)
+//  whole cache lines per buffer also keep two vectors' data from sharing a line
+//
+//	real::simd_vector<float> xs; // real::vector<float, real::simd_allocator<float, 64, true>>
+//	...
+//	for (size_t i = 0; i < xs.size(); i += 16)
+//		_mm512_store_ps(xs.data() + i, _mm512_mul_ps(_mm512_load_ps(xs.data() + i), scale));
+
+namespace real {
+	template <typename T, ::std::size_t Align = 64, bool ZeroFill = false> struct simd_allocator {
+		static_assert(::std::has_single_bit(Align) && Align >= alignof(T), "Align must be a power of two of at least alignof(T)");
+
+		using value_type                             = T;
+		using size_type                              = ::std::size_t;
+		using difference_type                        = ::std::ptrdiff_t;
+		using is_always_equal                        = ::std::true_type;
+		using propagate_on_container_move_assignment = ::std::true_type;
+
+		static constexpr ::std::size_t alignment = Align;
+		// values per Align bytes, 0 when T does not divide Align
+		static constexpr ::std::size_t lanes = Align % sizeof(T) ? 0 : Align / sizeof(T);
+
+		// Align and ZeroFill are not type parameters, allocator_traits cannot rebind on its own
+		template <typename U> struct rebind {
+			using other = simd_allocator<U, (Align < alignof(U) ? alignof(U) : Align), ZeroFill>;
+		};
+
+		constexpr simd_allocator() noexcept = default;
+		template <typename U, ::std::size_t A>
+		constexpr simd_allocator(const simd_allocator<U, A, ZeroFill> &) noexcept {
+		}
+
+		// bytes behind a block of count values
+		[[nodiscard]] static constexpr ::std::size_t padded_bytes(size_type count) noexcept {
+			return (count * sizeof(T) + (Align - 1)) & ~(Align - 1);
+		}
+
+		// values allocate_at_least(count) returns room for
+		[[nodiscard]] static constexpr size_type allocation_size(size_type count) noexcept {
+			return padded_bytes(count ? count : 1) / sizeof(T);
+		}
+
+		[[nodiscard]] allocation_result<T *> allocate_at_least(size_type count) {
+			if (count > (::std::numeric_limits<size_type>::max() - Align) / sizeof(T))
+				throw ::std::bad_array_new_length();
+			const ::std::size_t bytes = padded_bytes(count ? count : 1);
+			void *memory              = ::operator new(bytes, ::std::align_val_t{Align});
+			if constexpr (ZeroFill)
+				::std::memset(memory, 0, bytes);
+			return {static_cast<T *>(memory), allocation_size(count)};
+		}
+		[[nodiscard]] T *allocate(size_type count) {
+			return allocate_at_least(count).ptr;
+		}
+
+		// count is anything from what was asked for to what allocate_at_least returned, both round to the same bytes
+		void deallocate(T *ptr, size_type count) noexcept {
+			::operator delete(ptr, padded_bytes(count ? count : 1), ::std::align_val_t{Align});
+		}
+
+		template <typename U, ::std::size_t A>
+		friend constexpr bool operator==(const simd_allocator &, const simd_allocator<U, A, ZeroFill> &) noexcept {
+			return true;
+		}
+	};
+
+	template <typename T, ::std::size_t Align = 64, bool ZeroFill = true>
+	using simd_vector = vector<T, simd_allocator<T, Align, ZeroFill>>;
+
+	// zeroes [size(), capacity()) so full width loads past the end read zeros again, after pop_back, erase or clear
+	template <typename T, ::std::size_t Align, bool ZeroFill, typename Instrumentation>
+	void zero_tail(vector<T, simd_allocator<T, Align, ZeroFill>, Instrumentation> &values) noexcept {
+		static_assert(::std::is_trivially_copyable_v<T>, "zero_tail writes bytes past size()");
+		if (values.capacity() > values.size())
+			::std::memset(static_cast<void *>(values.data() + values.size()), 0,
+			              (values.capacity() - values.size()) * sizeof(T));
+	}
+} // namespace real
@@ -145,6 +145,9 @@ template <typename T, size_t N = 32> struct stable_stack {
 	using reverse_iterator       = ::std::reverse_iterator<iterator>;
 	using const_reverse_iterator = ::std::reverse_iterator<const_iterator>;
 
+	// values per block, each block is contiguous
+	static constexpr size_t block_size = N;
+
 	// emplace_back's
 	template <class... Args> constexpr reference emplace_back(Args &&...args) {
 		size_type d = _size / N;
@@ -0,0 +1,398 @@
+#pragma once
+#include "real_vector.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2021 Alex Anderson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// thin_vector<T>: a vector one pointer wide, size and capacity live in a header in front of the values inside
+//  the allocation, an empty (never grown) thin_vector is a null pointer and owns nothing
+//  meant for members of structs that number in the millions and are mostly empty (adjacency lists), where the
+//  two words saved per member beat the extra load through the header on size()
+//  the allocator must be stateless (there is nowhere to keep it), growth follows the expansion policies of
+//  real::vector (geometric_int_expansion_policy<2> by default)
+//
+//	struct node {
+//		real::thin_vector<uint32_t> edges; // 8 bytes
+//	};
+
+namespace real {
+	namespace details {
+		struct thin_header {
+			size_t size;
+			size_t capacity;
+		};
+
+		template <size_t Align> struct alignas(Align) thin_unit {
+			unsigned char bytes[Align];
+		};
+	} // namespace details
+
+	template <typename T, typename Allocator = ::std::allocator<T>> class thin_vector {
+		static_assert(::std::is_empty<Allocator>::value, "thin_vector keeps no allocator state, use a stateless allocator");
+
+	  public:
+		using element_type           = T;
+		using value_type             = typename ::std::remove_cv<T>::type;
+		using const_reference        = const value_type &;
+		using size_type              = ::std::size_t;
+		using difference_type        = ::std::ptrdiff_t;
+		using pointer                = element_type *;
+		using const_pointer          = const element_type *;
+		using reference              = element_type &;
+		using iterator               = pointer;
+		using const_iterator         = const_pointer;
+		using reverse_iterator       = ::std::reverse_iterator<iterator>;
+		using const_reverse_iterator = ::std::reverse_iterator<const_iterator>;
+		using allocator_type         = Allocator;
+
+	  private:
+		static constexpr size_type unit_align =
+			alignof(T) > alignof(details::thin_header) ? alignof(T) : alignof(details::thin_header);
+		using unit           = details::thin_unit<unit_align>;
+		using unit_allocator = typename ::std::allocator_traits<Allocator>::template rebind_alloc<unit>;
+		using unit_traits    = ::std::allocator_traits<unit_allocator>;
+
+		// values start at the first multiple of their alignment after the header
+		static constexpr size_type data_offset = (sizeof(details::thin_header) + unit_align - 1) / unit_align * unit_align;
+
+		details::thin_header *_header = nullptr;
+
+		[[nodiscard]] static constexpr size_type _units(size_type capacity) noexcept {
+			return (data_offset + capacity * sizeof(T) + unit_align - 1) / unit_align;
+		}
+		[[nodiscard]] T *_data() const noexcept {
+			return reinterpret_cast<T *>(reinterpret_cast<char *>(_header) + data_offset);
+		}
+
+		void _free() noexcept {
+			if (_header) {
+				details::destroy(begin(), end());
+				unit_allocator alloc;
+				unit_traits::deallocate(alloc, reinterpret_cast<unit *>(_header), _units(_header->capacity));
+				_header = nullptr;
+			}
+		}
+
+		// moves the values into a new block of new_capacity (>= size())
+		void _reallocate(size_type new_capacity) {
+			if (new_capacity > max_size())
+				throw ::std::length_error("cannot allocate larger than max_size");
+			unit_allocator        alloc;
+			unit                 *block  = unit_traits::allocate(alloc, _units(new_capacity));
+			details::thin_header *header = ::new ((void *)block) details::thin_header{size(), new_capacity};
+			T *data = reinterpret_cast<T *>(reinterpret_cast<char *>(header) + data_offset);
+			if (_header) {
+				try {
+					::std::uninitialized_move(begin(), end(), data);
+				} catch (...) {
+					unit_traits::deallocate(alloc, block, _units(new_capacity));
+					throw;
+				}
+				_free();
+			}
+			_header = header;
+		}
+
+		template <typename ExpansionPolicy> void _grow(size_type required_capacity) {
+			_reallocate(ExpansionPolicy{}.grow_capacity(size(), capacity(), required_capacity));
+		}
+
+	  public:
+		constexpr thin_vector() noexcept = default;
+
+		explicit thin_vector(size_type count, const value_type &value = value_type()) {
+			if (count) {
+				_reallocate(count);
+				try {
+					::std::uninitialized_fill_n(_data(), count, value);
+				} catch (...) {
+					_free(); // no destructor runs for a half built object
+					throw;
+				}
+				_header->size = count;
+			}
+		}
+
+		template <class Iterator, typename = typename ::std::iterator_traits<Iterator>::iterator_category>
+		thin_vector(Iterator first, Iterator last) {
+			try {
+				for (; first != last; ++first)
+					emplace_back(*first);
+			} catch (...) {
+				_free();
+				throw;
+			}
+		}
+
+		thin_vector(::std::initializer_list<T> ilist) : thin_vector(ilist.begin(), ilist.end()) {
+		}
+
+		thin_vector(const thin_vector &other) {
+			if (!other.empty()) {
+				_reallocate(other.size());
+				try {
+					::std::uninitialized_copy(other.begin(), other.end(), _data());
+				} catch (...) {
+					_free();
+					throw;
+				}
+				_header->size = other.size();
+			}
+		}
+
+		thin_vector(thin_vector &&other) noexcept : _header(::std::exchange(other._header, nullptr)) {
+		}
+
+		thin_vector &operator=(const thin_vector &other) {
+			if (this != &other) {
+				thin_vector copy(other);
+				swap(copy);
+			}
+			return *this;
+		}
+
+		thin_vector &operator=(thin_vector &&other) noexcept {
+			if (this != &other) {
+				_free();
+				_header = ::std::exchange(other._header, nullptr);
+			}
+			return *this;
+		}
+
+		~thin_vector() {
+			_free();
+		}
+
+		[[nodiscard]] allocator_type get_allocator() const noexcept {
+			return allocator_type();
+		}
+
+		// size / capacity
+		[[nodiscard]] size_type size() const noexcept {
+			return _header ? _header->size : 0;
+		}
+		[[nodiscard]] size_type capacity() const noexcept {
+			return _header ? _header->capacity : 0;
+		}
+		[[nodiscard]] bool empty() const noexcept {
+			return size() == 0;
+		}
+		[[nodiscard]] size_type max_size() const noexcept {
+			return (static_cast<size_type>(-1) - data_offset) / sizeof(T);
+		}
+
+		// data / iterators
+		[[nodiscard]] pointer data() noexcept {
+			return _header ? _data() : nullptr;
+		}
+		[[nodiscard]] const_pointer data() const noexcept {
+			return _header ? _data() : nullptr;
+		}
+		[[nodiscard]] iterator begin() noexcept {
+			return data();
+		}
+		[[nodiscard]] const_iterator begin() const noexcept {
+			return data();
+		}
+		[[nodiscard]] const_iterator cbegin() const noexcept {
+			return data();
+		}
+		[[nodiscard]] iterator end() noexcept {
+			return data() + size();
+		}
+		[[nodiscard]] const_iterator end() const noexcept {
+			return data() + size();
+		}
+		[[nodiscard]] const_iterator cend() const noexcept {
+			return data() + size();
+		}
+		[[nodiscard]] reverse_iterator rbegin() noexcept {
+			return reverse_iterator(end());
+		}
+		[[nodiscard]] const_reverse_iterator rbegin() const noexcept {
+			return const_reverse_iterator(end());
+		}
+		[[nodiscard]] reverse_iterator rend() noexcept {
+			return reverse_iterator(begin());
+		}
+		[[nodiscard]] const_reverse_iterator rend() const noexcept {
+			return const_reverse_iterator(begin());
+		}
+
+		//[]'s
+		[[nodiscard]] reference operator[](size_type pos) noexcept {
+			assert(pos < size());
+			return _data()[pos];
+		}
+		[[nodiscard]] const_reference operator[](size_type pos) const noexcept {
+			assert(pos < size());
+			return _data()[pos];
+		}
+		[[nodiscard]] reference at(size_type pos) {
+			if (!(pos < size()))
+				throw ::std::out_of_range("accessing index out of range of thin_vector");
+			return _data()[pos];
+		}
+		[[nodiscard]] const_reference at(size_type pos) const {
+			if (!(pos < size()))
+				throw ::std::out_of_range("accessing index out of range of thin_vector");
+			return _data()[pos];
+		}
+		[[nodiscard]] reference front() noexcept {
+			assert(!empty());
+			return _data()[0];
+		}
+		[[nodiscard]] const_reference front() const noexcept {
+			assert(!empty());
+			return _data()[0];
+		}
+		[[nodiscard]] reference back() noexcept {
+			assert(!empty());
+			return _data()[size() - 1];
+		}
+		[[nodiscard]] const_reference back() const noexcept {
+			assert(!empty());
+			return _data()[size() - 1];
+		}
+
+		void reserve(size_type new_capacity) {
+			if (new_capacity > capacity())
+				_reallocate(new_capacity);
+		}
+
+		// an empty thin_vector goes back to a null pointer
+		void shrink_to_fit() {
+			if (empty())
+				_free();
+			else if (size() != capacity())
+				_reallocate(size());
+		}
+
+		// emplace_back's
+		template <typename ExpansionPolicy = geometric_int_expansion_policy<2>, typename... Args>
+		reference emplace_back_with_policy(Args &&...args) {
+			if (size() == capacity()) {
+				value_type value(::std::forward<Args>(args)...); // args may refer into this vector
+				_grow<ExpansionPolicy>(size() + 1);
+				T *it = ::new ((void *)(_data() + _header->size)) T(::std::move(value));
+				_header->size += 1;
+				return *it;
+			}
+			T *it = ::new ((void *)(_data() + _header->size)) T(::std::forward<Args>(args)...);
+			_header->size += 1;
+			return *it;
+		}
+		template <class... Args> reference emplace_back(Args &&...args) {
+			return emplace_back_with_policy<geometric_int_expansion_policy<2>>(::std::forward<Args>(args)...);
+		}
+		void push_back(const T &value) {
+			emplace_back(value);
+		}
+		void push_back(T &&value) {
+			emplace_back(::std::move(value));
+		}
+
+		void pop_back() noexcept {
+			assert(!empty() && "pop_back on an empty thin_vector");
+			_header->size -= 1;
+			details::destroy_at(_data() + _header->size);
+		}
+
+		// keeps the allocation, see shrink_to_fit
+		void clear() noexcept {
+			if (_header) {
+				details::destroy(begin(), end());
+				_header->size = 0;
+			}
+		}
+
+		void resize(size_type count, const value_type &value = value_type()) {
+			const size_type old_size = size();
+			if (count > capacity()) {
+				const value_type copy = value; // value may live inside this vector
+				reserve(count);
+				::std::uninitialized_fill(_data() + old_size, _data() + count, copy);
+				_header->size = count;
+			} else if (count > old_size) {
+				::std::uninitialized_fill(_data() + old_size, _data() + count, value);
+				_header->size = count;
+			} else if (count < old_size) {
+				details::destroy(begin() + count, end());
+				_header->size = count;
+			}
+		}
+
+		// insert / emplace's, appended then rotated into place
+		template <class... Args> iterator emplace(const_iterator pos, Args &&...args) {
+			assert(pos >= cbegin() && pos <= cend() && "emplace iterator is out of bounds");
+			const size_type insert_idx = static_cast<size_type>(pos - cbegin());
+			emplace_back(::std::forward<Args>(args)...);
+			::std::rotate(begin() + insert_idx, end() - 1, end());
+			return begin() + insert_idx;
+		}
+		iterator insert(const_iterator pos, const T &value) {
+			return emplace(pos, value);
+		}
+		iterator insert(const_iterator pos, T &&value) {
+			return emplace(pos, ::std::move(value));
+		}
+
+		// erase's
+		iterator erase(const_iterator pos) {
+			return erase(pos, pos + 1);
+		}
+		iterator erase(const_iterator first, const_iterator last) {
+			assert(first >= cbegin() && first <= last && last <= cend() && "erase iterators are out of bounds");
+			const size_type erase_idx   = static_cast<size_type>(first - cbegin());
+			const size_type erase_count = static_cast<size_type>(last - first);
+			if (erase_count) {
+				iterator new_end = ::std::move(begin() + erase_idx + erase_count, end(), begin() + erase_idx);
+				details::destroy(new_end, end());
+				_header->size -= erase_count;
+			}
+			return begin() + erase_idx;
+		}
+
+		void swap(thin_vector &other) noexcept {
+			::std::swap(_header, other._header);
+		}
+		friend void swap(thin_vector &left, thin_vector &right) noexcept {
+			left.swap(right);
+		}
+
+		[[nodiscard]] friend bool operator==(const thin_vector &left, const thin_vector &right) {
+			return ::std::equal(left.begin(), left.end(), right.begin(), right.end());
+		}
+	};
+} // namespace real
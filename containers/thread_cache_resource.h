@@ -0,0 +1,231 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2021 Alex Anderson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// thread_cache_resource: a thread safe std::pmr::memory_resource keeping freed blocks on per thread free lists, one
+//  per size class, so the allocate / deallocate pairs of vectors growing and dying on one thread take no lock
+//  size classes come two per power of two (16, 24, 32, 48, 64, 96, ...), geometric_int_expansion_policy<2>
+//  doubles capacities, so a vector's buffers stay in one family of classes: exact for power of two sized values,
+//  exact for 3 * 2^k sized ones (12 and 24 byte structs), within 25% otherwise
+//  a thread list holding 2 * batch blocks hands batch of them to the shared pool in one locked transfer, an empty
+//  thread list takes up to batch back the same way before asking upstream
+//  options reuse std::pmr::pool_options: max_blocks_per_chunk is the batch (default 32), largest_required_pool_block
+//  the largest cached block (default 1 MiB), larger or over-aligned (past max_align_t) requests go to upstream
+//  memory is only returned to upstream when the resource is destroyed (a thread's list goes to the pool when
+//  the thread exits), threads must be done with the resource before it is destroyed
+//
+//	containers::thread_cache_resource cache;
+//	// on any thread
+//	pmr::real::vector<int> ids{&cache};
+
+namespace containers {
+    class thread_cache_resource : public ::std::pmr::memory_resource {
+      public:
+        static constexpr ::std::size_t min_block   = 16;
+        static constexpr ::std::size_t block_align = alignof(::std::max_align_t);
+
+        // class sizes 16, 24, 32, 48, ... (even indices are powers of two)
+        [[nodiscard]] static constexpr ::std::size_t size_class(::std::size_t bytes) noexcept {
+            if (bytes <= min_block)
+                return 0;
+            const ::std::size_t k    = static_cast<::std::size_t>(::std::bit_width(bytes - 1)); // 2^(k-1) < bytes <= 2^k
+            const ::std::size_t half = ::std::size_t{1} << (k - 1);
+            return 2 * (k - 4) - (bytes <= half + half / 2 ? 1 : 0);
+        }
+        [[nodiscard]] static constexpr ::std::size_t class_size(::std::size_t index) noexcept {
+            return (index % 2 ? 24 : 16) << (index / 2);
+        }
+
+      private:
+        struct free_block {
+            free_block *next;
+        };
+
+        struct free_list {
+            free_block   *head  = nullptr;
+            ::std::size_t count = 0;
+
+            void push(void *ptr) noexcept {
+                free_block *block = static_cast<free_block *>(ptr);
+                block->next       = head;
+                head              = block;
+                count++;
+            }
+            void *pop() noexcept {
+                free_block *block = head;
+                head              = block->next;
+                count--;
+                return block;
+            }
+            // moves up to n blocks onto other
+            void transfer(free_list &other, ::std::size_t n) noexcept {
+                for (; n && head; n--)
+                    other.push(pop());
+            }
+        };
+
+        struct thread_cache;
+
+        // everything the threads share, kept alive by their caches until they have detached
+        struct shared_state {
+            ::std::mutex                 mutex;
+            ::std::vector<free_list>     pool;
+            ::std::vector<thread_cache *> threads;
+            ::std::pmr::memory_resource *upstream;
+            ::std::size_t                batch;
+            bool                         alive = true;
+
+            void release(free_list &list, ::std::size_t index) noexcept {
+                while (list.head)
+                    upstream->deallocate(list.pop(), class_size(index), block_align);
+            }
+        };
+
+        struct thread_cache {
+            ::std::shared_ptr<shared_state> state;
+            ::std::vector<free_list>        lists;
+
+            // the thread is done, its blocks go to the pool (or were already freed by the resource's destructor)
+            ~thread_cache() {
+                ::std::lock_guard<::std::mutex> lock(state->mutex);
+                if (!state->alive)
+                    return;
+                for (::std::size_t i = 0; i < lists.size(); i++)
+                    lists[i].transfer(state->pool[i], lists[i].count);
+                state->threads.erase(::std::find(state->threads.begin(), state->threads.end(), this));
+            }
+        };
+
+        ::std::shared_ptr<shared_state> _state;
+        ::std::size_t                   _classes;
+        ::std::size_t                   _largest_block;
+
+        // this thread's cache for this resource, registered on first use
+        [[nodiscard]] thread_cache &_cache() {
+            thread_local ::std::vector<::std::unique_ptr<thread_cache>> caches;
+            for (::std::unique_ptr<thread_cache> &cache : caches)
+                if (cache->state == _state)
+                    return *cache;
+            // drop caches of resources that have gone away
+            ::std::erase_if(caches, [](const ::std::unique_ptr<thread_cache> &cache) {
+                ::std::lock_guard<::std::mutex> lock(cache->state->mutex);
+                return !cache->state->alive;
+            });
+            ::std::unique_ptr<thread_cache> cache(new thread_cache{_state, ::std::vector<free_list>(_classes)});
+            {
+                ::std::lock_guard<::std::mutex> lock(_state->mutex);
+                _state->threads.push_back(cache.get());
+            }
+            caches.push_back(::std::move(cache));
+            return *caches.back();
+        }
+
+        [[nodiscard]] bool _cached(::std::size_t bytes, ::std::size_t alignment) const noexcept {
+            return bytes <= _largest_block && alignment <= block_align;
+        }
+
+      public:
+        explicit thread_cache_resource(::std::pmr::memory_resource *upstream = ::std::pmr::get_default_resource())
+            : thread_cache_resource(::std::pmr::pool_options{}, upstream) {
+        }
+        explicit thread_cache_resource(const ::std::pmr::pool_options &options,
+                                       ::std::pmr::memory_resource    *upstream = ::std::pmr::get_default_resource())
+            : _state(::std::make_shared<shared_state>()) {
+            _largest_block   = options.largest_required_pool_block ? options.largest_required_pool_block : 1 << 20;
+            _largest_block   = class_size(size_class(_largest_block < min_block ? min_block : _largest_block));
+            _classes         = size_class(_largest_block) + 1;
+            _state->pool     = ::std::vector<free_list>(_classes);
+            _state->upstream = upstream;
+            _state->batch    = options.max_blocks_per_chunk ? options.max_blocks_per_chunk : 32;
+        }
+
+        thread_cache_resource(const thread_cache_resource &)            = delete;
+        thread_cache_resource &operator=(const thread_cache_resource &) = delete;
+
+        // frees the pool and every thread's list, the threads themselves must no longer be using the resource
+        ~thread_cache_resource() override {
+            ::std::lock_guard<::std::mutex> lock(_state->mutex);
+            for (thread_cache *cache : _state->threads)
+                for (::std::size_t i = 0; i < _classes; i++)
+                    _state->release(cache->lists[i], i);
+            for (::std::size_t i = 0; i < _classes; i++)
+                _state->release(_state->pool[i], i);
+            _state->threads.clear();
+            _state->alive = false;
+        }
+
+        [[nodiscard]] ::std::pmr::memory_resource *upstream_resource() const noexcept {
+            return _state->upstream;
+        }
+        [[nodiscard]] ::std::size_t largest_cached_block() const noexcept {
+            return _largest_block;
+        }
+        // blocks of each size class in the shared pool
+        [[nodiscard]] ::std::size_t pooled_blocks(::std::size_t index) {
+            ::std::lock_guard<::std::mutex> lock(_state->mutex);
+            return index < _classes ? _state->pool[index].count : 0;
+        }
+
+      protected:
+        void *do_allocate(::std::size_t bytes, ::std::size_t alignment) override {
+            if (!_cached(bytes, alignment))
+                return _state->upstream->allocate(bytes, alignment);
+            const ::std::size_t index = size_class(bytes);
+            free_list          &list  = _cache().lists[index];
+            if (!list.head) {
+                ::std::lock_guard<::std::mutex> lock(_state->mutex);
+                _state->pool[index].transfer(list, _state->batch);
+            }
+            if (list.head)
+                return list.pop();
+            return _state->upstream->allocate(class_size(index), block_align);
+        }
+
+        void do_deallocate(void *ptr, ::std::size_t bytes, ::std::size_t alignment) override {
+            if (!_cached(bytes, alignment)) {
+                _state->upstream->deallocate(ptr, bytes, alignment);
+                return;
+            }
+            const ::std::size_t index = size_class(bytes);
+            free_list          &list  = _cache().lists[index];
+            list.push(ptr);
+            if (list.count >= 2 * _state->batch) {
+                ::std::lock_guard<::std::mutex> lock(_state->mutex);
+                list.transfer(_state->pool[index], _state->batch);
+            }
+        }
+
+        bool do_is_equal(const ::std::pmr::memory_resource &other) const noexcept override {
+            return this == &other;
+        }
+    };
+} // namespace containers
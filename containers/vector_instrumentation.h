@@ -0,0 +1,132 @@
+#pragma once
+#include "real_vector.h"
+#include <cstddef>
+#include <ostream>
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2021 Alex Anderson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// counting_instrumentation<Tag>: a real::vector instrumentation policy with thread-local counters per Tag
+//  one Tag per call site (or per member), the counters are shared by every vector using that Tag
+//  Tag may name itself with a static constexpr const char *name
+//
+//	struct adjacency_site {
+//		static constexpr const char *name = "graph::adjacency";
+//	};
+//	real::vector<int, std::allocator<int>, real::counting_instrumentation<adjacency_site>> edges;
+//	...
+//	real::write_instrumentation_json(std::cout); // this thread's counters for every Tag used so far
+
+namespace real {
+	struct vector_counters {
+		size_t grows           = 0;
+		size_t shrinks         = 0;
+		size_t bytes_relocated = 0;
+		size_t reserves        = 0; // explicit reserve() calls
+		size_t back_inserts    = 0; // values, not calls
+		size_t middle_inserts  = 0;
+		size_t erases          = 0;
+		size_t max_size        = 0;
+		size_t max_capacity    = 0;
+	};
+
+	namespace details {
+		struct instrumentation_site {
+			const char                 *name;
+			vector_counters            *counters;
+			const instrumentation_site *next;
+		};
+
+		inline const instrumentation_site *&instrumentation_sites() noexcept {
+			thread_local const instrumentation_site *head = nullptr;
+			return head;
+		}
+
+		template <typename Tag> constexpr const char *instrumentation_name() noexcept {
+			if constexpr (requires { Tag::name; })
+				return Tag::name;
+			else
+				return "unnamed";
+		}
+	} // namespace details
+
+	template <typename Tag> struct counting_instrumentation {
+	  private:
+		// registers with this thread's site list the first time the thread touches Tag
+		struct registered_counters {
+			vector_counters               values;
+			details::instrumentation_site site;
+
+			registered_counters() noexcept
+				: site{details::instrumentation_name<Tag>(), &values, details::instrumentation_sites()} {
+				details::instrumentation_sites() = &site;
+			}
+		};
+
+	  public:
+		[[nodiscard]] static vector_counters &counters() noexcept {
+			thread_local registered_counters instance;
+			return instance.values;
+		}
+
+		static void on_grow(size_t /*old_capacity*/, size_t new_capacity, size_t bytes_relocated) noexcept {
+			vector_counters &c = counters();
+			c.grows++;
+			c.bytes_relocated += bytes_relocated;
+			c.max_capacity = new_capacity > c.max_capacity ? new_capacity : c.max_capacity;
+		}
+		static void on_shrink(size_t /*old_capacity*/, size_t /*new_capacity*/, size_t bytes_relocated) noexcept {
+			vector_counters &c = counters();
+			c.shrinks++;
+			c.bytes_relocated += bytes_relocated;
+		}
+		static void on_reserve(size_t /*requested_capacity*/) noexcept {
+			counters().reserves++;
+		}
+		static void on_insert(size_t pos, size_t count, size_t new_size) noexcept {
+			vector_counters &c = counters();
+			(pos + count == new_size ? c.back_inserts : c.middle_inserts) += count;
+			c.max_size = new_size > c.max_size ? new_size : c.max_size;
+		}
+		static void on_erase(size_t /*pos*/, size_t count, size_t /*new_size*/) noexcept {
+			counters().erases += count;
+		}
+	};
+
+	// writes the calling thread's counters, one object per Tag (most recently registered first)
+	inline void write_instrumentation_json(::std::ostream &out) {
+		out << "{\n    \"vectors\": [";
+		const char *separator = "\n";
+		for (const details::instrumentation_site *site = details::instrumentation_sites(); site; site = site->next) {
+			const vector_counters &c = *site->counters;
+			out << separator << "        {\"name\": \"" << site->name << "\", \"grows\": " << c.grows
+			    << ", \"shrinks\": " << c.shrinks << ", \"bytes_relocated\": " << c.bytes_relocated
+			    << ", \"reserves\": " << c.reserves << ", \"back_inserts\": " << c.back_inserts << ", \"middle_inserts\": " << c.middle_inserts
+			    << ", \"erases\": " << c.erases << ", \"max_size\": " << c.max_size
+			    << ", \"max_capacity\": " << c.max_capacity << "}";
+			separator = ",\n";
+		}
+		out << "\n    ]\n}\n";
+	}
+} // namespace real
@@ -0,0 +1,168 @@
+#pragma once
+#include "real_vector.h"
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2021 Alex Anderson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// trace_instrumentation<Tag>: a real::vector instrumentation policy recording every operation into a
+//  thread-local trace per Tag, replayable with containers_replay
+//  record one vector per Tag, operations of vectors sharing a Tag interleave into one trace
+//  recording allocates, running out of memory inside a hook terminates
+//
+//	struct session_ids {
+//		static constexpr const char *name = "session_ids";
+//	};
+//	real::vector<int, std::allocator<int>, real::trace_instrumentation<session_ids>> ids;
+//	...
+//	real::write_trace(file, real::trace_instrumentation<session_ids>::trace());
+//
+// the text format is one operation per line, # starts a comment
+//	push
+//	pop
+//	insert <pos> <count>
+//	erase <pos> <count>
+//	reserve <capacity>
+//	clear
+
+namespace real {
+	enum class trace_op_kind : uint8_t { push, pop, insert, erase, reserve, clear };
+
+	struct trace_op {
+		trace_op_kind kind  = trace_op_kind::push;
+		size_t        pos   = 0;
+		size_t        count = 0; // the capacity for reserve
+	};
+
+	using vector_trace = ::std::vector<trace_op>;
+
+	template <typename Tag> struct trace_instrumentation {
+		[[nodiscard]] static vector_trace &trace() noexcept {
+			thread_local vector_trace ops;
+			return ops;
+		}
+
+		static void on_grow(size_t /*old_capacity*/, size_t /*new_capacity*/, size_t /*bytes_relocated*/) noexcept {
+		}
+		static void on_shrink(size_t /*old_capacity*/, size_t /*new_capacity*/, size_t /*bytes_relocated*/) noexcept {
+		}
+		static void on_reserve(size_t requested_capacity) noexcept {
+			trace().push_back({trace_op_kind::reserve, 0, requested_capacity});
+		}
+		static void on_insert(size_t pos, size_t count, size_t new_size) noexcept {
+			if (count == 1 && pos + 1 == new_size)
+				trace().push_back({trace_op_kind::push, pos, 1});
+			else
+				trace().push_back({trace_op_kind::insert, pos, count});
+		}
+		// erasing everything is recorded as clear, erasing the last value as pop
+		static void on_erase(size_t pos, size_t count, size_t new_size) noexcept {
+			if (pos == 0 && new_size == 0)
+				trace().push_back({trace_op_kind::clear, 0, count});
+			else if (count == 1 && pos == new_size)
+				trace().push_back({trace_op_kind::pop, pos, 1});
+			else
+				trace().push_back({trace_op_kind::erase, pos, count});
+		}
+	};
+
+	inline void write_trace(::std::ostream &out, const vector_trace &trace) {
+		for (const trace_op &op : trace) {
+			switch (op.kind) {
+			case trace_op_kind::push:
+				out << "push\n";
+				break;
+			case trace_op_kind::pop:
+				out << "pop\n";
+				break;
+			case trace_op_kind::insert:
+				out << "insert " << op.pos << ' ' << op.count << '\n';
+				break;
+			case trace_op_kind::erase:
+				out << "erase " << op.pos << ' ' << op.count << '\n';
+				break;
+			case trace_op_kind::reserve:
+				out << "reserve " << op.count << '\n';
+				break;
+			case trace_op_kind::clear:
+				out << "clear\n";
+				break;
+			}
+		}
+	}
+
+	// appends to trace, false (with error naming the line) on an unknown operation or one out of range
+	//  of the size the trace has built up to that point, so a trace that reads replays safely
+	inline bool read_trace(::std::istream &in, vector_trace &trace, ::std::string &error) {
+		::std::string line;
+		size_t        line_number = 0;
+		size_t        size        = 0;
+		while (::std::getline(in, line)) {
+			line_number++;
+			::std::istringstream words(line.substr(0, line.find('#')));
+			::std::string        name;
+			if (!(words >> name))
+				continue;
+
+			trace_op op;
+			bool     valid = true;
+			if (name == "push") {
+				op    = {trace_op_kind::push, size, 1};
+				size += 1;
+			} else if (name == "pop") {
+				valid = size != 0;
+				op    = {trace_op_kind::pop, size - valid, 1};
+				size -= valid;
+			} else if (name == "insert") {
+				op.kind = trace_op_kind::insert;
+				valid   = static_cast<bool>(words >> op.pos >> op.count) && op.pos <= size;
+				size += valid ? op.count : 0;
+			} else if (name == "erase") {
+				op.kind = trace_op_kind::erase;
+				valid   = static_cast<bool>(words >> op.pos >> op.count) && op.pos <= size && op.count <= size - op.pos;
+				size -= valid ? op.count : 0;
+			} else if (name == "reserve") {
+				op.kind = trace_op_kind::reserve;
+				valid   = static_cast<bool>(words >> op.count);
+			} else if (name == "clear") {
+				op   = {trace_op_kind::clear, 0, size};
+				size = 0;
+			} else {
+				valid = false;
+			}
+			if (!valid) {
+				error = "line " + ::std::to_string(line_number) + ": invalid operation \"" + line + "\"";
+				return false;
+			}
+			trace.push_back(op);
+		}
+		return true;
+	}
+} // namespace real